@@ -0,0 +1,47 @@
+#ifndef BOOK_RECORD_H
+#define BOOK_RECORD_H
+
+#include "book.h"
+#include "book_table.h"
+
+#include <charconv>
+#include <expected>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// One-line text encoding of a Book shared by the network protocol and the
+// replication stream:
+//   <id>\t<title>\t<author>\t<isbn>\t<year>\t<category>\t<status>
+// Backslashes, tabs and line breaks inside fields are escaped as \\, \t, \n
+// and \r, so every record round-trips exactly.
+
+// Appends the record followed by a newline
+void appendBookRecord(const Book& book, std::string& out);
+void appendBookRecord(const BookView& book, std::string& out);
+[[nodiscard]] std::optional<Book> parseBookRecord(std::string_view line);
+
+void appendEscaped(std::string_view field, std::string& out);
+[[nodiscard]] std::string unescape(std::string_view field);
+
+[[nodiscard]] std::string_view statusName(BookStatus status);
+[[nodiscard]] std::optional<BookStatus> parseStatus(std::string_view name);
+
+// Fields of an ADD request, escaped as in a record:
+//   <title>\t<author>[\t<isbn>[\t<year>[\t<category>]]]
+// Fields are trimmed of spaces and the category defaults to "General".
+// Returns the book with its ID unset, or the reason it was rejected.
+[[nodiscard]] std::expected<Book, std::string_view> parseAddFields(std::string_view text);
+
+// A whole field of decimal digits, e.g. an ID, a year or a sequence number
+template <typename T = unsigned int>
+[[nodiscard]] std::optional<T> parseNumber(std::string_view text) {
+  T value{};
+  auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+  if (error != std::errc() || end != text.data() + text.size()) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+#endif // BOOK_RECORD_H
@@ -0,0 +1,196 @@
+#ifndef BOOK_TABLE_H
+#define BOOK_TABLE_H
+
+#include "book.h"
+#include "string_heap.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Compact stored form of a Book. Text lives in the table's StringHeap and
+// the ID is implied by the slot. Status and whether a year is known share
+// one byte; the year keeps a full word so every year round-trips.
+struct PackedBook {
+  static constexpr uint8_t kStatusMask = 0x3;
+  static constexpr uint8_t kHasYearBit = 0x4;
+
+  StringRef title;
+  StringRef author;
+  StringRef isbn;
+  StringRef category;
+  uint32_t year{0};
+  uint8_t flags{0};
+
+  [[nodiscard]] BookStatus status() const { return static_cast<BookStatus>(flags & kStatusMask); }
+  [[nodiscard]] std::optional<unsigned int> publicationYear() const {
+    if (!(flags & kHasYearBit)) {
+      return std::nullopt;
+    }
+    return year;
+  }
+};
+
+// Read-only view of a stored book with the same getters as Book.
+// Valid until the table it came from is next modified.
+class BookView {
+public:
+  [[nodiscard]] unsigned int getBookID() const { return book_id_; }
+  [[nodiscard]] std::string_view getTitle() const { return heap_->view(record_->title); }
+  [[nodiscard]] std::string_view getAuthor() const { return heap_->view(record_->author); }
+  [[nodiscard]] std::string_view getISBN() const { return heap_->view(record_->isbn); }
+  [[nodiscard]] std::optional<unsigned int> getPublicationYear() const {
+    return record_->publicationYear();
+  }
+  [[nodiscard]] std::string_view getCategory() const { return heap_->view(record_->category); }
+  [[nodiscard]] BookStatus getStatus() const { return record_->status(); }
+
+  [[nodiscard]] bool isAvailable() const { return getStatus() == BookStatus::Available; }
+  [[nodiscard]] bool isBorrowed() const { return getStatus() == BookStatus::Borrowed; }
+
+  [[nodiscard]] Book toBook() const;
+
+private:
+  friend class BookTable;
+
+  BookView(unsigned int book_id, const PackedBook& record, const StringHeap& heap)
+      : book_id_(book_id), record_(&record), heap_(&heap) {}
+
+  unsigned int book_id_;
+  const PackedBook* record_;
+  const StringHeap* heap_;
+};
+
+// Approximate heap bytes held by a BookTable
+struct BookTableMemoryUsage {
+  size_t records{0};        // directory and chunks of packed records
+  size_t strings{0};        // string heap and category intern table
+  size_t string_garbage{0}; // heap bytes no stored book refers to any more
+
+  [[nodiscard]] size_t total() const { return records + strings; }
+};
+
+// Catalog storage indexed by book ID with copy-on-write sharing.
+// Slots live in fixed-size chunks reached through a directory. Copying a
+// table is O(1): both copies share the directory, chunks and string heap,
+// and a writer clones the directory and the one chunk it touches only while
+// they are still shared. Chunks left empty by erase() are released
+// immediately. Text is appended to the heap and categories are interned;
+// text replaced or erased stays in the heap until compact().
+class BookTable {
+public:
+  static constexpr size_t kChunkSize = 64;
+
+  BookTable() = default;
+
+  [[nodiscard]] std::optional<BookView> find(unsigned int book_id) const;
+  [[nodiscard]] bool contains(unsigned int book_id) const;
+
+  // Stores the book in the slot for its ID, replacing any previous entry.
+  // Throws std::length_error once the string heap is full, leaving the
+  // table unchanged apart from unreferenced heap bytes.
+  void insert(const Book& book);
+  bool erase(unsigned int book_id);
+  bool setStatus(unsigned int book_id, BookStatus status);
+
+  [[nodiscard]] size_t size() const;
+  [[nodiscard]] bool empty() const;
+
+  // Highest stored ID, if any
+  [[nodiscard]] std::optional<unsigned int> lastBookID() const;
+
+  // Rewrites the string heap without garbage and releases directory capacity
+  // past the last stored book. Chunks are addressed by ID, so a partially
+  // filled chunk stays until its IDs are reused or all of its books are erased.
+  void compact();
+
+  // Includes chunks and heap blocks shared with snapshots
+  [[nodiscard]] BookTableMemoryUsage memoryUsage() const;
+
+  // Visits every book in ascending ID order
+  template <typename Visitor> void forEach(Visitor&& visitor) const {
+    if (!directory_) {
+      return;
+    }
+    for (size_t index = 0; index < directory_->size(); ++index) {
+      const auto& chunk = (*directory_)[index];
+      if (!chunk) {
+        continue;
+      }
+      for (uint64_t mask = chunk->occupied; mask != 0; mask &= mask - 1) {
+        auto slot = static_cast<size_t>(std::countr_zero(mask));
+        visitor(BookView(static_cast<unsigned int>(index * kChunkSize + slot),
+                         chunk->slots[slot],
+                         heap_));
+      }
+    }
+  }
+
+  // Visits books with IDs from first_id on in ascending order for as long as
+  // the visitor returns true. Returns false if the visitor stopped early.
+  template <typename Visitor> bool forEachFrom(unsigned int first_id, Visitor&& visitor) const {
+    if (!directory_) {
+      return true;
+    }
+    for (size_t index = first_id / kChunkSize; index < directory_->size(); ++index) {
+      const auto& chunk = (*directory_)[index];
+      if (!chunk) {
+        continue;
+      }
+      uint64_t mask = chunk->occupied;
+      if (index == first_id / kChunkSize) {
+        mask &= ~uint64_t{0} << (first_id % kChunkSize);
+      }
+      for (; mask != 0; mask &= mask - 1) {
+        auto slot = static_cast<size_t>(std::countr_zero(mask));
+        if (!visitor(BookView(static_cast<unsigned int>(index * kChunkSize + slot),
+                              chunk->slots[slot],
+                              heap_))) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+private:
+  struct Chunk {
+    std::array<PackedBook, kChunkSize> slots;
+    uint64_t occupied{0}; // one bit per slot in use
+  };
+
+  // Hashes string_view too, so lookups need not build a std::string
+  struct CategoryHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view category) const {
+      return std::hash<std::string_view>{}(category);
+    }
+  };
+
+  using Directory = std::vector<std::shared_ptr<Chunk>>;
+  using CategoryTable = std::unordered_map<std::string, StringRef, CategoryHash, std::equal_to<>>;
+
+  std::shared_ptr<Directory> directory_;
+  StringHeap heap_;
+  std::shared_ptr<CategoryTable> categories_;
+  size_t size_{0};
+  uint64_t garbage_bytes_{0};
+
+  [[nodiscard]] const PackedBook* findRecord(unsigned int book_id) const;
+  [[nodiscard]] PackedBook pack(const Book& book);
+  [[nodiscard]] StringRef internCategory(std::string_view category);
+  void retire(const PackedBook& record);
+
+  [[nodiscard]] Directory& mutableDirectory();
+  [[nodiscard]] Chunk& mutableChunk(size_t index);
+};
+
+#endif // BOOK_TABLE_H
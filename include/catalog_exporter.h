@@ -0,0 +1,63 @@
+#ifndef CATALOG_EXPORTER_H
+#define CATALOG_EXPORTER_H
+
+#include "book.h"
+#include "catalog_snapshot.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+enum class ExportFormat { Csv, JsonLines };
+
+struct ExportOptions {
+  static constexpr size_t kDefaultBufferSize = 1024 * 1024;
+
+  ExportFormat format{ExportFormat::Csv};
+  // Only books matching every filter that is set are written
+  std::optional<std::string> category;
+  std::optional<BookStatus> status;
+  size_t buffer_size{kDefaultBufferSize};
+};
+
+struct ExportStats {
+  size_t rows{0};
+  uint64_t bytes{0};
+  double seconds{0.0};
+
+  [[nodiscard]] double rowsPerSecond() const;
+  [[nodiscard]] double megabytesPerSecond() const;
+};
+
+// Streams a catalog snapshot in ID order without materializing it.
+// Rows are formatted into a fixed-size buffer that is handed to the stream
+// in one large write whenever it fills, so memory use does not grow with
+// the catalog.
+//
+// CSV has a header row and quotes fields as in RFC 4180. JSON Lines writes
+// one object per book with "year" set to null when unknown. Status values
+// use the names from book_record.h.
+class CatalogExporter {
+public:
+  explicit CatalogExporter(ExportOptions options = {});
+
+  // Throws std::runtime_error if the stream fails
+  ExportStats write(const CatalogSnapshot& snapshot, std::ostream& out);
+
+  // "csv" or "jsonl"
+  [[nodiscard]] static std::optional<ExportFormat> parseFormat(std::string_view name);
+
+private:
+  ExportOptions options_;
+  std::string buffer_;
+
+  [[nodiscard]] bool matches(const BookView& book) const;
+  void appendCsv(const BookView& book);
+  void appendJson(const BookView& book);
+  void flush(std::ostream& out, ExportStats& stats);
+};
+
+#endif // CATALOG_EXPORTER_H
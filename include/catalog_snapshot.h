@@ -0,0 +1,50 @@
+#ifndef CATALOG_SNAPSHOT_H
+#define CATALOG_SNAPSHOT_H
+
+#include "book.h"
+#include "book_table.h"
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Immutable, consistent view of the catalog at the moment it was taken.
+// Taking a snapshot is O(1) and never blocks later writes: the manager keeps
+// mutating its own copy of the table and clones only what it touches. Once
+// created, a snapshot may be read from any thread, and the storage it pins
+// is released when the last copy of it is destroyed.
+class CatalogSnapshot {
+public:
+  CatalogSnapshot() = default;
+
+  [[nodiscard]] std::optional<Book> getBook(unsigned int book_id) const;
+  [[nodiscard]] std::vector<Book> getAllBooks() const;
+
+  [[nodiscard]] size_t getTotalBooks() const;
+  [[nodiscard]] size_t getAvailableBooks() const;
+
+  // Sequence number of the last change included in this snapshot
+  [[nodiscard]] uint64_t getSequence() const;
+
+  // Visits every book in ascending ID order as a BookView, without copying
+  template <typename Visitor> void forEachBook(Visitor&& visitor) const {
+    books_.forEach(std::forward<Visitor>(visitor));
+  }
+
+  // Resumable form of forEachBook, see BookTable::forEachFrom
+  template <typename Visitor> bool forEachBookFrom(unsigned int first_id, Visitor&& visitor) const {
+    return books_.forEachFrom(first_id, std::forward<Visitor>(visitor));
+  }
+
+private:
+  friend class LibraryManager;
+
+  CatalogSnapshot(BookTable books, size_t available_books, uint64_t sequence);
+
+  BookTable books_;
+  size_t available_books_{0};
+  uint64_t sequence_{0};
+};
+
+#endif // CATALOG_SNAPSHOT_H
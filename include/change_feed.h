@@ -0,0 +1,62 @@
+#ifndef CHANGE_FEED_H
+#define CHANGE_FEED_H
+
+#include "book.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+enum class ChangeType { Add, Remove, Update, Borrow, Return };
+
+struct ChangeEvent {
+  uint64_t sequence{0};
+  ChangeType type{ChangeType::Add};
+  unsigned int book_id{0};
+  std::optional<Book> book; // state after Add and Update; empty otherwise
+};
+
+struct ChangeBatch {
+  std::vector<ChangeEvent> events;
+  uint64_t next_sequence{1}; // pass to the next pull
+  bool overrun{false};       // events before events.front() were already dropped
+};
+
+// Bounded ring buffer of catalog mutations with consecutive sequence numbers.
+// Consumers pull batches from a sequence of their choosing at their own pace;
+// the writer never waits for them. A consumer that falls more than capacity()
+// events behind gets a batch flagged as overrun and must resynchronise from a
+// snapshot. All methods are safe to call from any thread.
+class ChangeFeed {
+public:
+  explicit ChangeFeed(size_t capacity);
+
+  ChangeFeed(const ChangeFeed&) = delete;
+  ChangeFeed& operator=(const ChangeFeed&) = delete;
+
+  void append(ChangeEvent event);
+
+  [[nodiscard]] ChangeBatch pull(uint64_t from_sequence, size_t max_events) const;
+
+  // Blocks until an event with the given sequence exists or the timeout expires
+  [[nodiscard]] bool waitFor(uint64_t sequence, std::chrono::milliseconds timeout) const;
+
+  [[nodiscard]] uint64_t lastSequence() const;
+  [[nodiscard]] uint64_t oldestSequence() const;
+  [[nodiscard]] size_t capacity() const;
+
+private:
+  mutable std::mutex mutex_;
+  mutable std::condition_variable appended_;
+  std::vector<ChangeEvent> ring_;
+  uint64_t first_sequence_{0}; // first sequence ever appended, 0 while empty
+  uint64_t last_sequence_{0};
+
+  [[nodiscard]] uint64_t oldestRetained() const;
+};
+
+#endif // CHANGE_FEED_H
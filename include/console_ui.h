@@ -26,6 +26,7 @@ private:
   void handleBorrowBook();
   void handleReturnBook();
   void handleStatistics();
+  void handleExport();
 
   void displayBook(const Book& book);
   std::string readLine(const std::string& prompt);
@@ -0,0 +1,20 @@
+#ifndef COPY_ON_WRITE_H
+#define COPY_ON_WRITE_H
+
+#include <atomic>
+#include <memory>
+
+// Helpers for state shared between a writer and the snapshots taken from it.
+
+// A writer may modify shared state in place only once no snapshot refers to
+// it. The acquire fence pairs with the release decrement performed when the
+// last other owner let go, so that owner's reads happen before our writes.
+template <typename T> bool uniquelyOwned(const std::shared_ptr<T>& ptr) {
+  if (ptr.use_count() != 1) {
+    return false;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return true;
+}
+
+#endif // COPY_ON_WRITE_H
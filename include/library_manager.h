@@ -3,13 +3,58 @@
 #define LIBRARY_MANAGER_H
 
 #include "book.h"
+#include "book_table.h"
+#include "catalog_snapshot.h"
+#include "change_feed.h"
+#include "query_cache.h"
+#include "roaring_bitmap.h"
+#include "search_index.h"
 
+#include <array>
+#include <functional>
+#include <map>
 #include <memory>
 #include <optional>
+#include <string>
 #include <string_view>
-#include <unordered_map>
 #include <vector>
 
+// Number of books per facet value. Decades are keyed by their first year
+// (e.g. 1990 for 1990-1999); books without a publication year have no decade.
+struct FacetCounts {
+  std::map<std::string, size_t> by_category;
+  std::map<BookStatus, size_t> by_status;
+  std::map<unsigned int, size_t> by_decade;
+};
+
+// How addBook picks IDs. Monotonic never hands out an ID twice; ReuseRetired
+// hands out the lowest free ID first, keeping the ID space dense.
+enum class IdPolicy { Monotonic, ReuseRetired };
+
+// Approximate heap bytes held by each part of the catalog
+struct CatalogMemoryUsage {
+  size_t books{0};
+  size_t book_records{0};   // table overhead: directory and packed records
+  size_t book_strings{0};   // string heap and interned categories
+  size_t string_garbage{0}; // part of book_strings no book refers to, see compact()
+  size_t facet_indexes{0};
+  size_t search_index{0};
+  size_t query_cache{0};
+  size_t free_ids{0};
+
+  [[nodiscard]] size_t total() const {
+    return book_records + book_strings + facet_indexes + search_index + query_cache + free_ids;
+  }
+  [[nodiscard]] double bytesPerBook() const {
+    return books > 0 ? static_cast<double>(total()) / static_cast<double>(books) : 0.0;
+  }
+};
+
+struct CompactionReport {
+  CatalogMemoryUsage before;
+  CatalogMemoryUsage after;
+};
+
 class LibraryManager {
 public:
   LibraryManager() = default;
@@ -34,6 +79,9 @@ public:
   [[nodiscard]] std::vector<Book> searchByAuthor(std::string_view author) const;
   [[nodiscard]] std::vector<Book> searchByCategory(std::string_view category) const;
 
+  // Best k title/author matches ranked by BM25, highest score first
+  [[nodiscard]] std::vector<Book> searchRanked(std::string_view query, size_t k = 20) const;
+
   // Borrow/Return operations
   [[nodiscard]] bool borrowBook(unsigned int book_id);
   [[nodiscard]] bool returnBook(unsigned int book_id);
@@ -41,9 +89,76 @@ public:
   [[nodiscard]] size_t getTotalBooks() const;
   [[nodiscard]] size_t getAvailableBooks() const;
 
+  // Consistent read-only view for long-running reports; O(1) to take
+  [[nodiscard]] CatalogSnapshot snapshot() const;
+
+  // Facet counts over the whole catalog or over a search result set
+  [[nodiscard]] FacetCounts getFacetCounts() const;
+  [[nodiscard]] FacetCounts getFacetCounts(const std::vector<Book>& results) const;
+  [[nodiscard]] FacetCounts getFacetCounts(const RoaringBitmap& result_ids) const;
+
+  // Optional bounded LRU cache for search results
+  void enableQueryCache(size_t capacity);
+  void disableQueryCache();
+  [[nodiscard]] QueryCacheStats getQueryCacheStats() const;
+
+  // Change data capture: every mutation gets the next sequence number and,
+  // once enabled, is recorded in a bounded feed that consumers pull from
+  void enableChangeFeed(size_t capacity);
+  [[nodiscard]] std::shared_ptr<const ChangeFeed> getChangeFeed() const;
+  [[nodiscard]] uint64_t getChangeSequence() const;
+
+  // Switching to ReuseRetired makes every unused ID below the next one available
+  void setIdPolicy(IdPolicy policy);
+  [[nodiscard]] IdPolicy getIdPolicy() const;
+
+  // Releases capacity left behind by removals in the catalog and every index.
+  // Under ReuseRetired, free IDs above the highest stored one are dropped too.
+  CompactionReport compact();
+  [[nodiscard]] CatalogMemoryUsage getMemoryUsage() const;
+
+  // Replication: replace the whole catalog with a primary's snapshot, then
+  // replay its changes in order, keeping the primary's IDs and sequences
+  void loadCatalog(const std::vector<Book>& books, uint64_t sequence);
+  void applyChange(const ChangeEvent& event);
+
 private:
-  std::unordered_map<unsigned int, Book> books_;
+  static constexpr size_t kStatusCount = 4;
+
+  BookTable books_;
   unsigned int next_book_id_{1};
+  IdPolicy id_policy_{IdPolicy::Monotonic};
+  RoaringBitmap free_ids_; // unused IDs below next_book_id_ under ReuseRetired
+
+  // Facet posting lists over book IDs
+  // Transparent comparator: lookups by string_view need not build a string
+  std::map<std::string, RoaringBitmap, std::less<>> category_bitmaps_;
+  std::array<RoaringBitmap, kStatusCount> status_bitmaps_;
+  std::map<unsigned int, RoaringBitmap> decade_bitmaps_;
+
+  SearchIndex search_index_;
+
+  // Lookups refresh LRU order and counters, so const queries may touch the cache
+  mutable std::optional<QueryCache> query_cache_;
+
+  uint64_t change_sequence_{0};
+  std::shared_ptr<ChangeFeed> change_feed_;
+
+  [[nodiscard]] unsigned int allocateBookID();
+  void rebuildFreeIDs();
+  void insertBook(const Book& book);
+  void indexFacets(const Book& book);
+  void unindexFacets(const BookView& book);
+  void setStatus(unsigned int book_id, BookStatus from, BookStatus to);
+
+  void invalidate(std::initializer_list<CatalogField> fields);
+  void recordChange(ChangeType type,
+                    unsigned int book_id,
+                    std::optional<BookView> book = std::nullopt);
+  [[nodiscard]] std::optional<std::vector<Book>> cachedBooks(std::string_view key) const;
+  void cacheBooks(std::string key,
+                  const std::vector<Book>& books,
+                  std::initializer_list<CatalogField> depends_on) const;
 };
 
 #endif // LIBRARY_MANAGER_H
@@ -0,0 +1,92 @@
+#ifndef LIBRARY_SERVER_H
+#define LIBRARY_SERVER_H
+
+#include "library_manager.h"
+#include "request_handler.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Event-driven TCP front end for LibraryManager (Linux, epoll).
+// A single thread owns the manager and multiplexes every connection with
+// non-blocking sockets. Each read may carry many pipelined requests; complete
+// lines are answered in order and the responses are written back together.
+// Once a connection has more than kMaxPendingOutput unsent bytes, its
+// remaining requests stay buffered and it is not read from again until the
+// client catches up.
+class LibraryServer {
+public:
+  static constexpr size_t kMaxPendingOutput = 4 * 1024 * 1024;
+
+  // Port 0 binds an ephemeral port, see port()
+  LibraryServer(LibraryManager& manager, std::string_view host, uint16_t port);
+  ~LibraryServer();
+
+  LibraryServer(const LibraryServer&) = delete;
+  LibraryServer& operator=(const LibraryServer&) = delete;
+
+  [[nodiscard]] uint16_t port() const;
+
+  // Serves connections until stop() is called
+  void run();
+
+  // Safe to call from any thread or a signal handler
+  void stop();
+
+  // Calls handler from the event loop whenever fd becomes readable
+  void watch(int fd, std::function<void()> handler);
+  void unwatch(int fd);
+
+  // Calls handler after every batch of events and at least once per interval
+  void setTickHandler(std::function<void()> handler, std::chrono::milliseconds interval);
+
+  // Forwarded to the request handler
+  void setReadOnly(bool read_only);
+  void setLagSource(std::function<uint64_t()> lag);
+
+  // Most unsent bytes any connection has had queued; safe to call from any thread
+  [[nodiscard]] size_t peakPendingOutput() const;
+
+private:
+  static constexpr size_t kReadChunkSize = 64 * 1024;
+  static constexpr int kMaxEvents = 256;
+
+  struct Connection {
+    std::string input;
+    std::string output;
+    size_t output_offset{0};
+    uint32_t events{0}; // epoll interest currently registered
+    bool reading{true};
+    bool peer_closed{false};
+  };
+
+  RequestHandler handler_;
+  std::array<char, kReadChunkSize> read_buffer_{};
+  int listen_fd_{-1};
+  int epoll_fd_{-1};
+  int wake_fd_{-1};
+  uint16_t port_{0};
+  std::unordered_map<int, Connection> connections_;
+  std::unordered_map<int, std::function<void()>> watched_;
+  std::function<void()> tick_handler_;
+  int tick_interval_ms_{-1};
+  std::atomic<size_t> peak_pending_output_{0};
+
+  void acceptConnections();
+  void handleReadable(int fd);
+  void handleWritable(int fd);
+  void processRequests(Connection& connection);
+  bool flush(int fd, Connection& connection);
+  bool flushAndResume(int fd, Connection& connection);
+  void updateInterest(int fd, Connection& connection);
+  void closeConnection(int fd);
+};
+
+#endif // LIBRARY_SERVER_H
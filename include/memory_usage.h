@@ -0,0 +1,37 @@
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Approximate heap footprint of standard containers for memory reporting.
+// Allocated capacity is counted rather than live elements; allocator
+// bookkeeping and the footprint of nested elements are not.
+
+inline size_t heapBytes(const std::string& text) {
+  // Short strings live inside the object itself
+  return text.capacity() > std::string().capacity() ? text.capacity() + 1 : 0;
+}
+
+template <typename T> size_t heapBytes(const std::vector<T>& vector) {
+  return vector.capacity() * sizeof(T);
+}
+
+// Bucket array plus one node per element holding the value, a link and the cached hash
+template <typename K, typename V, typename H, typename E, typename A>
+size_t heapBytes(const std::unordered_map<K, V, H, E, A>& map) {
+  using Value = typename std::unordered_map<K, V, H, E, A>::value_type;
+  return map.bucket_count() * sizeof(void*) + map.size() * (sizeof(Value) + 2 * sizeof(void*));
+}
+
+// One tree node per element holding the value, three links and a colour
+template <typename K, typename V, typename C, typename A>
+size_t heapBytes(const std::map<K, V, C, A>& map) {
+  using Value = typename std::map<K, V, C, A>::value_type;
+  return map.size() * (sizeof(Value) + 4 * sizeof(void*));
+}
+
+#endif // MEMORY_USAGE_H
@@ -0,0 +1,74 @@
+#ifndef QUERY_CACHE_H
+#define QUERY_CACHE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Catalog fields whose changes can invalidate cached query results
+enum class CatalogField : size_t { Membership, Title, Author, Category, Status };
+
+struct QueryCacheStats {
+  uint64_t hits{0};
+  uint64_t misses{0};
+  uint64_t evictions{0};
+  uint64_t invalidations{0};
+  size_t size{0};
+  size_t capacity{0};
+};
+
+// Bounded LRU cache of query results keyed by normalized query.
+// Every entry remembers the generation of each field it depends on; mutations
+// bump the generation of the fields they touch, so stale entries are detected
+// on lookup without walking the cache.
+class QueryCache {
+public:
+  // Matching book IDs in result order
+  using Value = std::vector<unsigned int>;
+
+  explicit QueryCache(size_t capacity);
+
+  // The index refers into the entry list, so the cache is move-only
+  QueryCache(const QueryCache&) = delete;
+  QueryCache& operator=(const QueryCache&) = delete;
+  QueryCache(QueryCache&&) noexcept = default;
+  QueryCache& operator=(QueryCache&&) noexcept = default;
+
+  [[nodiscard]] const Value* lookup(std::string_view key);
+  void store(std::string key, Value value, std::initializer_list<CatalogField> depends_on);
+
+  void bump(CatalogField field);
+  void clear();
+
+  [[nodiscard]] QueryCacheStats getStats() const;
+  [[nodiscard]] size_t memoryUsage() const;
+
+private:
+  static constexpr size_t kFieldCount = 5;
+
+  using Generations = std::array<uint64_t, kFieldCount>;
+
+  struct Entry {
+    std::string key;
+    Value value;
+    uint32_t field_mask{0};
+    Generations generations{};
+  };
+
+  size_t capacity_;
+  std::list<Entry> entries_; // most recently used first
+  std::unordered_map<std::string_view, std::list<Entry>::iterator> index_;
+  Generations generations_{};
+  QueryCacheStats stats_;
+
+  [[nodiscard]] bool isFresh(const Entry& entry) const;
+  void erase(std::list<Entry>::iterator it);
+};
+
+#endif // QUERY_CACHE_H
@@ -0,0 +1,146 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include "library_manager.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Primary/replica replication over a Unix domain socket.
+//
+// The primary sends each new replica a full catalog transfer followed by the
+// ordered stream of changes from its change feed:
+//
+//   SNAPSHOT <sequence> <count>     followed by <count> book records
+//   DELTA <sequence> ADD <book record>
+//   DELTA <sequence> UPDATE <book record>
+//   DELTA <sequence> REMOVE|BORROW|RETURN <id>
+//   HEAD <sequence>                 latest sequence on the primary
+//
+// A replica that falls further behind than the change feed retains is sent a
+// fresh SNAPSHOT. Neither side blocks: both are driven from an event loop.
+
+// Primary side. Enables the manager's change feed if it is not already on.
+// Replica sockets are multiplexed on an internal epoll instance, so slow
+// replicas are written to as soon as they can take more and disconnected
+// ones are dropped right away. Each replica has at most kMaxPendingOutput
+// bytes queued; a snapshot is streamed from a CatalogSnapshot in chunks of
+// that size rather than built in memory at once.
+class ReplicationPublisher {
+public:
+  static constexpr size_t kDefaultFeedCapacity = 65536;
+  static constexpr size_t kMaxPendingOutput = 4 * 1024 * 1024;
+
+  ReplicationPublisher(LibraryManager& manager, std::string_view socket_path);
+  ~ReplicationPublisher();
+
+  ReplicationPublisher(const ReplicationPublisher&) = delete;
+  ReplicationPublisher& operator=(const ReplicationPublisher&) = delete;
+
+  // Readable when replicas are waiting to be accepted, can take more output
+  // or have disconnected; call handleEvents() then
+  [[nodiscard]] int fd() const;
+  void handleEvents();
+
+  // Sends pending changes to every replica; call after mutations
+  void publish();
+
+  [[nodiscard]] size_t replicaCount() const;
+  // Bytes queued for all replicas and not yet sent
+  [[nodiscard]] size_t pendingOutput() const;
+
+private:
+  static constexpr size_t kMaxBatch = 1024;
+  static constexpr int kMaxEvents = 64;
+
+  struct Replica {
+    uint64_t next_sequence{1};
+    uint64_t head_sent{0};
+    std::string output;
+    size_t output_offset{0};
+    uint32_t events{0}; // epoll interest currently registered
+
+    // Snapshot still being streamed, resumed from snapshot_next_id
+    std::optional<CatalogSnapshot> snapshot;
+    unsigned int snapshot_next_id{0};
+  };
+
+  LibraryManager& manager_;
+  std::shared_ptr<const ChangeFeed> feed_;
+  std::string socket_path_;
+  int listen_fd_{-1};
+  int epoll_fd_{-1};
+  std::unordered_map<int, Replica> replicas_;
+
+  void acceptReplicas();
+  void startSnapshot(Replica& replica);
+  void fillOutput(Replica& replica, uint64_t head);
+  bool publishTo(int fd, Replica& replica, uint64_t head);
+  bool updateInterest(int fd, Replica& replica);
+  void dropReplica(int fd);
+  static bool flush(int fd, Replica& replica);
+};
+
+// Replica side. Applies everything received to the given manager, which
+// should not be modified by anything else. Deltas must arrive in sequence;
+// on a gap the replica reconnects, which makes the primary send a fresh
+// snapshot, and keeps serving its last consistent state meanwhile.
+class ReplicationClient {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  ReplicationClient(LibraryManager& manager, std::string_view socket_path);
+  ~ReplicationClient();
+
+  ReplicationClient(const ReplicationClient&) = delete;
+  ReplicationClient& operator=(const ReplicationClient&) = delete;
+
+  // Readable when the primary has sent data. Stays the same across
+  // reconnects, so an event loop can keep watching it.
+  [[nodiscard]] int fd() const;
+
+  // Applies whatever has arrived; returns false once the primary is gone
+  bool poll();
+
+  [[nodiscard]] bool isBootstrapped() const;
+  [[nodiscard]] uint64_t appliedSequence() const;
+  [[nodiscard]] uint64_t primarySequence() const;
+  // Number of primary changes not yet applied here
+  [[nodiscard]] uint64_t lag() const;
+  [[nodiscard]] Clock::time_point lastContact() const;
+  // Reconnects after a gap in the delta stream
+  [[nodiscard]] size_t resyncCount() const;
+
+private:
+  static constexpr size_t kReadChunkSize = 64 * 1024;
+  static constexpr size_t kMaxReadsPerPoll = 16;
+
+  LibraryManager& manager_;
+  std::string socket_path_;
+  int epoll_fd_{-1};
+  int socket_fd_{-1};
+  std::string input_;
+  bool bootstrapped_{false};
+  bool gap_detected_{false};
+  size_t resync_count_{0};
+  uint64_t primary_sequence_{0};
+  Clock::time_point last_contact_;
+
+  // Snapshot being received
+  uint64_t snapshot_sequence_{0};
+  size_t snapshot_remaining_{0};
+  std::vector<Book> snapshot_books_;
+
+  void connect();
+  bool resync();
+  bool handleLine(std::string_view line);
+  bool handleDelta(std::string_view args);
+};
+
+#endif // REPLICATION_H
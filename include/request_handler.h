@@ -0,0 +1,55 @@
+#ifndef REQUEST_HANDLER_H
+#define REQUEST_HANDLER_H
+
+#include "book_record.h"
+#include "library_manager.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// Line-delimited text protocol over LibraryManager, one response per request:
+//
+//   GET <id>
+//   SEARCH TITLE|AUTHOR|CATEGORY|RANKED <query>
+//   ADD <title>\t<author>[\t<isbn>[\t<year>[\t<category>]]]
+//   BORROW <id>
+//   RETURN <id>
+//   STATS
+//   COMPACT                 release storage left behind by removals
+//
+// Responses start with "OK" or "ERR <message>". Requests returning books
+// answer "OK <count>" followed by one book record per line (see book_record.h).
+// ADD fields use the same escaping as book records.
+class RequestHandler {
+public:
+  explicit RequestHandler(LibraryManager& manager);
+
+  // Appends the response to a request line (without its newline) to out
+  void handle(std::string_view request, std::string& out);
+
+  // Rejects ADD, BORROW and RETURN, e.g. on a read replica
+  void setReadOnly(bool read_only);
+
+  // Adds "lag=<n>" to STATS, e.g. the replication lag of a read replica
+  void setLagSource(std::function<uint64_t()> lag);
+
+private:
+  LibraryManager& manager_;
+  bool read_only_{false};
+  std::function<uint64_t()> lag_;
+
+  void handleGet(std::string_view args, std::string& out);
+  void handleSearch(std::string_view args, std::string& out);
+  void handleAdd(std::string_view args, std::string& out);
+  void handleBorrow(std::string_view args, std::string& out);
+  void handleReturn(std::string_view args, std::string& out);
+  void handleStats(std::string& out);
+  void handleCompact(std::string& out);
+
+  static void appendBooks(const std::vector<Book>& books, std::string& out);
+  static void appendError(std::string_view message, std::string& out);
+};
+
+#endif // REQUEST_HANDLER_H
@@ -0,0 +1,63 @@
+#ifndef ROARING_BITMAP_H
+#define ROARING_BITMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Compressed bitmap over 32-bit IDs in the style of Roaring bitmaps.
+// The ID space is split into chunks of 2^16 values keyed by the high 16 bits;
+// each chunk is stored as a sorted array of low bits while sparse and as a
+// 65536-bit bitmap once it holds more than kArrayMaxSize values.
+class RoaringBitmap {
+public:
+  RoaringBitmap() = default;
+
+  void add(uint32_t value);
+  bool remove(uint32_t value);
+  void clear();
+
+  [[nodiscard]] bool contains(uint32_t value) const;
+  [[nodiscard]] size_t cardinality() const;
+  [[nodiscard]] bool empty() const;
+  [[nodiscard]] std::optional<uint32_t> minimum() const;
+  [[nodiscard]] std::optional<uint32_t> maximum() const;
+
+  // Set operations
+  [[nodiscard]] RoaringBitmap intersect(const RoaringBitmap& other) const;
+  [[nodiscard]] size_t intersectionCardinality(const RoaringBitmap& other) const;
+
+  [[nodiscard]] std::vector<uint32_t> toVector() const;
+
+  // Releases spare capacity left behind by removals
+  void shrinkToFit();
+  [[nodiscard]] size_t memoryUsage() const;
+
+  friend bool operator==(const RoaringBitmap& lhs, const RoaringBitmap& rhs);
+
+private:
+  static constexpr size_t kArrayMaxSize = 4096;
+  static constexpr size_t kBitmapWords = 65536 / 64;
+
+  struct Container {
+    uint16_t key{0};
+    uint32_t cardinality{0};
+    std::vector<uint16_t> array;  // sorted low bits while sparse
+    std::vector<uint64_t> bitmap; // kBitmapWords words once dense
+
+    [[nodiscard]] bool isBitmap() const { return !bitmap.empty(); }
+    [[nodiscard]] bool contains(uint16_t low) const;
+    bool add(uint16_t low);
+    bool remove(uint16_t low);
+  };
+
+  std::vector<Container> containers_; // sorted by key
+
+  [[nodiscard]] const Container* findContainer(uint16_t key) const;
+
+  static size_t intersectionCardinality(const Container& lhs, const Container& rhs);
+  static Container intersect(const Container& lhs, const Container& rhs);
+};
+
+#endif // ROARING_BITMAP_H
@@ -0,0 +1,65 @@
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct SearchHit {
+  unsigned int book_id{0};
+  double score{0.0};
+};
+
+// Inverted index over title and author tokens scored with BM25.
+// Each field is scored separately against its own average length and the
+// per-field scores are combined with field boosts (title outweighs author).
+class SearchIndex {
+public:
+  SearchIndex() = default;
+
+  void addDocument(unsigned int book_id, std::string_view title, std::string_view author);
+  void removeDocument(unsigned int book_id, std::string_view title, std::string_view author);
+
+  // Best k matches, highest score first; ties are broken by lower book ID
+  [[nodiscard]] std::vector<SearchHit> search(std::string_view query, size_t k) const;
+
+  [[nodiscard]] size_t documentCount() const;
+
+  // Rehashes the term and document tables and trims posting lists after removals
+  void compact();
+  [[nodiscard]] size_t memoryUsage() const;
+
+  // Alphanumeric tokens with ASCII letters lowercased; non-ASCII UTF-8 bytes are
+  // word characters, and '+' and '#' are kept so "C++" and "C#" survive
+  [[nodiscard]] static std::vector<std::string> tokenize(std::string_view text);
+
+private:
+  static constexpr size_t kFieldCount = 2;
+  static constexpr std::array<double, kFieldCount> kFieldBoosts{2.0, 1.0};
+  static constexpr double kK1 = 1.2;
+  static constexpr double kB = 0.75;
+
+  enum Field : size_t { Title = 0, Author = 1 };
+
+  struct Posting {
+    unsigned int book_id{0};
+    std::array<uint16_t, kFieldCount> term_frequency{};
+  };
+
+  using FieldLengths = std::array<uint16_t, kFieldCount>;
+
+  std::unordered_map<std::string, std::vector<Posting>> postings_; // sorted by book ID
+  std::unordered_map<unsigned int, FieldLengths> field_lengths_;
+  std::array<uint64_t, kFieldCount> total_field_length_{};
+
+  static bool postingBefore(const Posting& posting, unsigned int book_id);
+
+  [[nodiscard]] static std::unordered_map<std::string, Posting>
+  termFrequencies(unsigned int book_id, std::string_view title, std::string_view author);
+};
+
+#endif // SEARCH_INDEX_H
@@ -0,0 +1,63 @@
+#ifndef STRING_HEAP_H
+#define STRING_HEAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Location of a string inside a StringHeap
+struct StringRef {
+  uint32_t offset{0};
+  uint32_t length{0};
+};
+
+// Append-only byte arena addressed by 32-bit offsets.
+// Bytes are stored in 64 KiB windows; a string never straddles two blocks,
+// so every string is contiguous. Longer strings get a block spanning as many
+// windows as they need. Copies share their blocks copy-on-write: the block
+// being appended to is cloned first if another copy still refers to it, and
+// earlier blocks are never written again.
+class StringHeap {
+public:
+  static constexpr uint32_t kWindowBits = 16;
+  static constexpr uint32_t kWindowSize = uint32_t{1} << kWindowBits;
+
+  StringHeap() = default;
+
+  // Throws std::length_error once the heap would pass 4 GiB
+  [[nodiscard]] StringRef append(std::string_view text);
+  [[nodiscard]] std::string_view view(StringRef ref) const {
+    if (ref.length == 0) {
+      return {};
+    }
+    return {pages_->windows[ref.offset >> kWindowBits] + (ref.offset & (kWindowSize - 1)),
+            ref.length};
+  }
+
+  // Bytes handed out so far, including padding at window ends
+  [[nodiscard]] uint64_t size() const;
+  // Bytes allocated for blocks
+  [[nodiscard]] size_t memoryUsage() const;
+
+private:
+  struct Block {
+    std::shared_ptr<char[]> data;
+    uint32_t first_window{0};
+    uint32_t window_count{0};
+  };
+
+  struct Pages {
+    std::vector<Block> blocks;
+    std::vector<const char*> windows; // start of each window's bytes
+  };
+
+  std::shared_ptr<Pages> pages_;
+  uint64_t size_{0};
+
+  [[nodiscard]] Pages& mutablePages();
+  [[nodiscard]] char* writableTail(Pages& pages);
+};
+
+#endif // STRING_HEAP_H
@@ -0,0 +1,153 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include "book.h"
+#include "library_manager.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Synthetic catalogs and operation traces for capacity planning
+
+enum class OperationType : size_t {
+  Get,
+  SearchTitle,
+  SearchAuthor,
+  SearchCategory,
+  SearchRanked,
+  Add,
+  Borrow,
+  Return,
+};
+
+inline constexpr size_t kOperationTypeCount = 8;
+
+// One catalog operation. book_id is used by GET, BORROW and RETURN; text
+// holds the query of a search or the fields of an ADD.
+struct Operation {
+  OperationType type{OperationType::Get};
+  unsigned int book_id{0};
+  std::string text;
+};
+
+// Traces store one operation per line in the request syntax of
+// request_handler.h, e.g. "BORROW 42" or "SEARCH TITLE Garden", so a trace
+// can also be sent to a running server.
+
+// Appends the operation followed by a newline
+void appendOperation(const Operation& operation, std::string& out);
+[[nodiscard]] std::optional<Operation> parseOperation(std::string_view line);
+
+// Short name used in reports and operation mixes, e.g. "search_title"
+[[nodiscard]] std::string_view operationName(OperationType type);
+[[nodiscard]] std::optional<OperationType> parseOperationName(std::string_view name);
+
+// Zipf distribution over ranks 0..n-1 with P(k) proportional to 1/(k+1)^s.
+// Sampling is a binary search in the running sums of the weights, which
+// addRank extends without renormalizing.
+class ZipfDistribution {
+public:
+  ZipfDistribution(size_t n, double exponent);
+
+  [[nodiscard]] size_t operator()(std::mt19937_64& random) const;
+  [[nodiscard]] size_t size() const;
+
+  // Appends rank n, the least likely one
+  void addRank();
+
+private:
+  double exponent_;
+  std::vector<double> cumulative_;
+};
+
+// Relative weight of each operation type, indexed by OperationType
+using OperationMix = std::array<unsigned int, kOperationTypeCount>;
+
+// Read-heavy mix with borrows and returns in balance
+inline constexpr OperationMix kDefaultOperationMix = {30, 15, 10, 5, 10, 2, 14, 14};
+
+struct WorkloadOptions {
+  size_t books{100000};
+  uint64_t seed{1};
+  // Zipf exponent for how often each book is requested; 0 is uniform
+  double popularity_skew{1.0};
+  OperationMix mix{kDefaultOperationMix};
+};
+
+// Generates a catalog and a stream of operations against it. Titles, authors
+// and categories are drawn from fixed vocabularies with Zipf popularity, so
+// a few authors and categories hold most books, as in a real library.
+// Borrows and searches favour popular books; returns pick a book borrowed
+// earlier in the stream. Each ADD is assumed to get the next ID, as from
+// populate, and joins the popularity ranking at a random rank.
+//
+// The catalog depends only on the seed and book count, and is generated
+// from its own random stream, so a recorded trace can be replayed against
+// an identical catalog without generating the trace again.
+class WorkloadGenerator {
+public:
+  explicit WorkloadGenerator(WorkloadOptions options);
+
+  // Next synthetic book; its ID is left unset
+  [[nodiscard]] Book nextBook();
+
+  // Adds options.books books to an empty catalog, so IDs run from 1 to books
+  void populate(LibraryManager& manager);
+
+  [[nodiscard]] Operation nextOperation();
+
+  // Name of the author with the given popularity rank, distinct for every rank
+  [[nodiscard]] static std::string authorName(size_t index);
+
+private:
+  WorkloadOptions options_;
+  std::mt19937_64 catalog_random_;
+  std::mt19937_64 operation_random_;
+
+  ZipfDistribution words_;
+  ZipfDistribution authors_;
+  ZipfDistribution categories_;
+  ZipfDistribution popularity_;
+  std::vector<unsigned int> books_by_popularity_;
+  OperationMix mix_bounds_; // running sums of the mix weights
+
+  unsigned int book_count_{0};
+  std::vector<bool> on_loan_;          // indexed by book ID
+  std::vector<unsigned int> borrowed_; // borrowed in this stream, not yet returned
+
+  [[nodiscard]] Book makeBook(std::mt19937_64& random) const;
+  [[nodiscard]] unsigned int popularBook();
+  void addedBook();
+};
+
+struct OperationStats {
+  size_t count{0};
+  size_t rejected{0};          // missing books, unavailable borrows, empty search results
+  std::vector<uint64_t> nanos; // latency of each operation, sorted after replay
+
+  // p in [0, 1]
+  [[nodiscard]] uint64_t percentile(double p) const;
+};
+
+struct ReplayReport {
+  std::array<OperationStats, kOperationTypeCount> operations;
+  double seconds{0.0};
+
+  [[nodiscard]] size_t count() const;
+  [[nodiscard]] double operationsPerSecond() const;
+};
+
+// Runs every operation against the manager on the calling thread and times
+// each one. ADD fields are decoded with parseAddFields, as the server does,
+// before the clock starts.
+[[nodiscard]] ReplayReport replayOperations(LibraryManager& manager,
+                                            std::span<const Operation> operations);
+
+#endif // WORKLOAD_H
@@ -0,0 +1,184 @@
+#include "../include/book_record.h"
+
+#include <array>
+#include <vector>
+
+namespace {
+
+constexpr size_t kRecordFields = 7;
+
+std::string_view trim(std::string_view text) {
+  while (!text.empty() && (text.front() == ' ' || text.front() == '\r')) {
+    text.remove_prefix(1);
+  }
+  while (!text.empty() && (text.back() == ' ' || text.back() == '\r')) {
+    text.remove_suffix(1);
+  }
+  return text;
+}
+
+template <typename BookLike> void appendRecord(const BookLike& book, std::string& out) {
+  out += std::to_string(book.getBookID());
+  out += '\t';
+  appendEscaped(book.getTitle(), out);
+  out += '\t';
+  appendEscaped(book.getAuthor(), out);
+  out += '\t';
+  appendEscaped(book.getISBN(), out);
+  out += '\t';
+  if (auto year = book.getPublicationYear()) {
+    out += std::to_string(*year);
+  }
+  out += '\t';
+  appendEscaped(book.getCategory(), out);
+  out += '\t';
+  out += statusName(book.getStatus());
+  out += '\n';
+}
+
+} // namespace
+
+void appendBookRecord(const Book& book, std::string& out) {
+  appendRecord(book, out);
+}
+
+void appendBookRecord(const BookView& book, std::string& out) {
+  appendRecord(book, out);
+}
+
+std::optional<Book> parseBookRecord(std::string_view line) {
+  std::array<std::string_view, kRecordFields> fields;
+  for (size_t i = 0; i < kRecordFields; ++i) {
+    size_t tab = line.find('\t');
+    if ((tab == std::string_view::npos) != (i == kRecordFields - 1)) {
+      return std::nullopt;
+    }
+    fields[i] = line.substr(0, tab);
+    line.remove_prefix(tab == std::string_view::npos ? line.size() : tab + 1);
+  }
+
+  auto book_id = parseNumber(fields[0]);
+  auto status = parseStatus(fields[6]);
+  std::optional<unsigned int> year;
+  if (!fields[4].empty()) {
+    year = parseNumber(fields[4]);
+    if (!year) {
+      return std::nullopt;
+    }
+  }
+  if (!book_id || !status) {
+    return std::nullopt;
+  }
+
+  Book book(*book_id,
+            unescape(fields[1]),
+            unescape(fields[2]),
+            unescape(fields[3]),
+            year,
+            unescape(fields[5]));
+  book.setStatus(*status);
+  return book;
+}
+
+void appendEscaped(std::string_view field, std::string& out) {
+  for (char c : field) {
+    switch (c) {
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    default:
+      out.push_back(c);
+    }
+  }
+}
+
+std::string unescape(std::string_view field) {
+  std::string result;
+  result.reserve(field.size());
+
+  for (size_t i = 0; i < field.size(); ++i) {
+    if (field[i] != '\\' || i + 1 == field.size()) {
+      result.push_back(field[i]);
+      continue;
+    }
+
+    switch (field[++i]) {
+    case 't':
+      result.push_back('\t');
+      break;
+    case 'n':
+      result.push_back('\n');
+      break;
+    case 'r':
+      result.push_back('\r');
+      break;
+    default:
+      result.push_back(field[i]);
+    }
+  }
+
+  return result;
+}
+
+std::string_view statusName(BookStatus status) {
+  switch (status) {
+  case BookStatus::Available:
+    return "Available";
+  case BookStatus::Borrowed:
+    return "Borrowed";
+  case BookStatus::Reserved:
+    return "Reserved";
+  case BookStatus::UnderMaintenance:
+    return "UnderMaintenance";
+  }
+  return "Unknown";
+}
+
+std::optional<BookStatus> parseStatus(std::string_view name) {
+  for (auto status : {BookStatus::Available,
+                      BookStatus::Borrowed,
+                      BookStatus::Reserved,
+                      BookStatus::UnderMaintenance}) {
+    if (statusName(status) == name) {
+      return status;
+    }
+  }
+  return std::nullopt;
+}
+
+std::expected<Book, std::string_view> parseAddFields(std::string_view text) {
+  std::vector<std::string> fields;
+  while (true) {
+    size_t tab = text.find('\t');
+    fields.push_back(unescape(trim(text.substr(0, tab))));
+    if (tab == std::string_view::npos) {
+      break;
+    }
+    text.remove_prefix(tab + 1);
+  }
+
+  if (fields.size() < 2 || fields[0].empty() || fields[1].empty()) {
+    return std::unexpected("title and author are required");
+  }
+
+  std::string_view isbn = fields.size() > 2 ? std::string_view(fields[2]) : "";
+  std::optional<unsigned int> year;
+  if (fields.size() > 3 && !fields[3].empty()) {
+    year = parseNumber(fields[3]);
+    if (!year) {
+      return std::unexpected("invalid publication year");
+    }
+  }
+  std::string_view category =
+      fields.size() > 4 && !fields[4].empty() ? std::string_view(fields[4]) : "General";
+  return Book(0, fields[0], fields[1], isbn, year, category);
+}
@@ -0,0 +1,254 @@
+#include "../include/book_table.h"
+#include "../include/copy_on_write.h"
+#include "../include/memory_usage.h"
+
+#include <algorithm>
+
+namespace {
+
+uint64_t slotBit(unsigned int book_id) {
+  return uint64_t{1} << (book_id % BookTable::kChunkSize);
+}
+
+} // namespace
+
+static_assert(BookTable::kChunkSize == 64, "occupancy is tracked in one 64-bit word");
+static_assert(static_cast<uint8_t>(BookStatus::UnderMaintenance) <= PackedBook::kStatusMask);
+
+// BookView
+
+Book BookView::toBook() const {
+  Book book(book_id_, getTitle(), getAuthor(), getISBN(), getPublicationYear(), getCategory());
+  book.setStatus(getStatus());
+  return book;
+}
+
+// BookTable
+
+std::optional<BookView> BookTable::find(unsigned int book_id) const {
+  const PackedBook* record = findRecord(book_id);
+  if (record == nullptr) {
+    return std::nullopt;
+  }
+  return BookView(book_id, *record, heap_);
+}
+
+bool BookTable::contains(unsigned int book_id) const {
+  return findRecord(book_id) != nullptr;
+}
+
+void BookTable::insert(const Book& book) {
+  unsigned int book_id = book.getBookID();
+  size_t index = book_id / kChunkSize;
+
+  // Packing may throw once the heap is full; leave the previous entry intact
+  PackedBook record = pack(book);
+  if (const PackedBook* previous = findRecord(book_id)) {
+    retire(*previous);
+  }
+
+  Directory& directory = mutableDirectory();
+  if (index >= directory.size()) {
+    directory.resize(index + 1);
+  }
+
+  Chunk& chunk = mutableChunk(index);
+  if (!(chunk.occupied & slotBit(book_id))) {
+    chunk.occupied |= slotBit(book_id);
+    ++size_;
+  }
+  chunk.slots[book_id % kChunkSize] = record;
+}
+
+bool BookTable::erase(unsigned int book_id) {
+  const PackedBook* record = findRecord(book_id);
+  if (record == nullptr) {
+    return false;
+  }
+
+  retire(*record);
+  size_t index = book_id / kChunkSize;
+  Directory& directory = mutableDirectory();
+  --size_;
+
+  // Drop the last book of a chunk without cloning it first
+  if (directory[index]->occupied == slotBit(book_id)) {
+    directory[index].reset();
+    return true;
+  }
+
+  Chunk& chunk = mutableChunk(index);
+  chunk.occupied &= ~slotBit(book_id);
+  chunk.slots[book_id % kChunkSize] = PackedBook{};
+  return true;
+}
+
+bool BookTable::setStatus(unsigned int book_id, BookStatus status) {
+  if (findRecord(book_id) == nullptr) {
+    return false;
+  }
+
+  PackedBook& record = mutableChunk(book_id / kChunkSize).slots[book_id % kChunkSize];
+  record.flags =
+      static_cast<uint8_t>((record.flags & ~PackedBook::kStatusMask) |
+                           static_cast<uint8_t>(status));
+  return true;
+}
+
+size_t BookTable::size() const {
+  return size_;
+}
+
+bool BookTable::empty() const {
+  return size_ == 0;
+}
+
+std::optional<unsigned int> BookTable::lastBookID() const {
+  if (!directory_) {
+    return std::nullopt;
+  }
+
+  for (size_t index = directory_->size(); index-- > 0;) {
+    const auto& chunk = (*directory_)[index];
+    if (chunk) {
+      return static_cast<unsigned int>(index * kChunkSize + 63 -
+                                       std::countl_zero(chunk->occupied));
+    }
+  }
+  return std::nullopt;
+}
+
+void BookTable::compact() {
+  if (size_ == 0) {
+    *this = BookTable();
+    return;
+  }
+  if (!directory_) {
+    return;
+  }
+
+  size_t used = *lastBookID() / kChunkSize + 1;
+  if (used != directory_->size() || used != directory_->capacity()) {
+    // A fresh directory shares the chunks and leaves snapshots untouched
+    directory_ = std::make_shared<Directory>(directory_->begin(), directory_->begin() + used);
+  }
+
+  if (garbage_bytes_ == 0) {
+    return;
+  }
+
+  // Copy every live string into a new heap; snapshots keep the old one
+  StringHeap old_heap = std::move(heap_);
+  heap_ = StringHeap();
+  categories_.reset();
+  garbage_bytes_ = 0;
+
+  for (size_t index = 0; index < used; ++index) {
+    if (!(*directory_)[index]) {
+      continue;
+    }
+    Chunk& chunk = mutableChunk(index);
+    for (uint64_t mask = chunk.occupied; mask != 0; mask &= mask - 1) {
+      PackedBook& record = chunk.slots[std::countr_zero(mask)];
+      record.title = heap_.append(old_heap.view(record.title));
+      record.author = heap_.append(old_heap.view(record.author));
+      record.isbn = heap_.append(old_heap.view(record.isbn));
+      record.category = internCategory(old_heap.view(record.category));
+    }
+  }
+}
+
+BookTableMemoryUsage BookTable::memoryUsage() const {
+  BookTableMemoryUsage usage;
+
+  if (directory_) {
+    usage.records = sizeof(Directory) + heapBytes(*directory_);
+    for (const auto& chunk : *directory_) {
+      if (chunk) {
+        usage.records += sizeof(Chunk);
+      }
+    }
+  }
+
+  usage.strings = heap_.memoryUsage();
+  if (categories_) {
+    usage.strings += heapBytes(*categories_);
+    for (const auto& [category, ref] : *categories_) {
+      usage.strings += heapBytes(category);
+    }
+  }
+  usage.string_garbage = garbage_bytes_;
+  return usage;
+}
+
+const PackedBook* BookTable::findRecord(unsigned int book_id) const {
+  size_t index = book_id / kChunkSize;
+  if (!directory_ || index >= directory_->size()) {
+    return nullptr;
+  }
+
+  const auto& chunk = (*directory_)[index];
+  if (!chunk || !(chunk->occupied & slotBit(book_id))) {
+    return nullptr;
+  }
+  return &chunk->slots[book_id % kChunkSize];
+}
+
+PackedBook BookTable::pack(const Book& book) {
+  PackedBook record;
+  record.title = heap_.append(book.getTitle());
+  record.author = heap_.append(book.getAuthor());
+  record.isbn = heap_.append(book.getISBN());
+  record.category = internCategory(book.getCategory());
+
+  record.flags = static_cast<uint8_t>(book.getStatus());
+  if (auto year = book.getPublicationYear()) {
+    record.year = *year;
+    record.flags |= PackedBook::kHasYearBit;
+  }
+  return record;
+}
+
+StringRef BookTable::internCategory(std::string_view category) {
+  if (category.empty()) {
+    return {};
+  }
+  if (categories_) {
+    if (auto it = categories_->find(category); it != categories_->end()) {
+      return it->second;
+    }
+  }
+
+  if (!categories_) {
+    categories_ = std::make_shared<CategoryTable>();
+  } else if (!uniquelyOwned(categories_)) {
+    categories_ = std::make_shared<CategoryTable>(*categories_);
+  }
+  StringRef ref = heap_.append(category);
+  categories_->emplace(category, ref);
+  return ref;
+}
+
+void BookTable::retire(const PackedBook& record) {
+  // Interned categories stay in use
+  garbage_bytes_ += uint64_t{record.title.length} + record.author.length + record.isbn.length;
+}
+
+BookTable::Directory& BookTable::mutableDirectory() {
+  if (!directory_) {
+    directory_ = std::make_shared<Directory>();
+  } else if (!uniquelyOwned(directory_)) {
+    directory_ = std::make_shared<Directory>(*directory_);
+  }
+  return *directory_;
+}
+
+BookTable::Chunk& BookTable::mutableChunk(size_t index) {
+  auto& chunk = mutableDirectory()[index];
+  if (!chunk) {
+    chunk = std::make_shared<Chunk>();
+  } else if (!uniquelyOwned(chunk)) {
+    chunk = std::make_shared<Chunk>(*chunk);
+  }
+  return *chunk;
+}
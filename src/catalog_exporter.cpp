@@ -0,0 +1,205 @@
+#include "../include/catalog_exporter.h"
+
+#include "../include/book_record.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr std::string_view kCsvHeader = "id,title,author,isbn,year,category,status\n";
+
+void appendNumber(unsigned int value, std::string& out) {
+  std::array<char, 16> digits;
+  auto [end, error] = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+  out.append(digits.data(), end);
+}
+
+void appendCsvField(std::string_view field, std::string& out) {
+  if (field.find_first_of(",\"\r\n") == std::string_view::npos) {
+    out += field;
+    return;
+  }
+
+  out += '"';
+  for (char c : field) {
+    if (c == '"') {
+      out += '"';
+    }
+    out += c;
+  }
+  out += '"';
+}
+
+void appendJsonString(std::string_view text, std::string& out) {
+  static constexpr std::string_view kHex = "0123456789abcdef";
+
+  out += '"';
+  // Copy runs of plain characters in one go
+  while (!text.empty()) {
+    auto special = std::find_if(text.begin(), text.end(), [](char c) {
+      return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+    });
+    out.append(text.begin(), special);
+    if (special == text.end()) {
+      break;
+    }
+
+    auto c = static_cast<unsigned char>(*special);
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      out += "\\u00";
+      out += kHex[c >> 4];
+      out += kHex[c & 0xF];
+    }
+    text.remove_prefix(special - text.begin() + 1);
+  }
+  out += '"';
+}
+
+} // namespace
+
+double ExportStats::rowsPerSecond() const {
+  return seconds > 0.0 ? static_cast<double>(rows) / seconds : 0.0;
+}
+
+double ExportStats::megabytesPerSecond() const {
+  return seconds > 0.0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds : 0.0;
+}
+
+CatalogExporter::CatalogExporter(ExportOptions options) : options_(std::move(options)) {
+  options_.buffer_size = std::max<size_t>(options_.buffer_size, 4096);
+}
+
+ExportStats CatalogExporter::write(const CatalogSnapshot& snapshot, std::ostream& out) {
+  auto start = std::chrono::steady_clock::now();
+  ExportStats stats;
+
+  // Leave room for the row that crosses the flush threshold
+  buffer_.clear();
+  buffer_.reserve(options_.buffer_size + options_.buffer_size / 4);
+
+  if (options_.format == ExportFormat::Csv) {
+    buffer_ += kCsvHeader;
+  }
+
+  snapshot.forEachBook([&](const BookView& book) {
+    if (!matches(book)) {
+      return;
+    }
+
+    if (options_.format == ExportFormat::Csv) {
+      appendCsv(book);
+    } else {
+      appendJson(book);
+    }
+    ++stats.rows;
+
+    if (buffer_.size() >= options_.buffer_size) {
+      flush(out, stats);
+    }
+  });
+
+  flush(out, stats);
+  out.flush();
+  if (!out) {
+    throw std::runtime_error("catalog export failed");
+  }
+
+  // Release the buffer between exports
+  std::string().swap(buffer_);
+
+  stats.seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return stats;
+}
+
+std::optional<ExportFormat> CatalogExporter::parseFormat(std::string_view name) {
+  if (name == "csv") {
+    return ExportFormat::Csv;
+  }
+  if (name == "jsonl") {
+    return ExportFormat::JsonLines;
+  }
+  return std::nullopt;
+}
+
+bool CatalogExporter::matches(const BookView& book) const {
+  if (options_.status && book.getStatus() != *options_.status) {
+    return false;
+  }
+  return !options_.category || book.getCategory() == *options_.category;
+}
+
+void CatalogExporter::appendCsv(const BookView& book) {
+  appendNumber(book.getBookID(), buffer_);
+  buffer_ += ',';
+  appendCsvField(book.getTitle(), buffer_);
+  buffer_ += ',';
+  appendCsvField(book.getAuthor(), buffer_);
+  buffer_ += ',';
+  appendCsvField(book.getISBN(), buffer_);
+  buffer_ += ',';
+  if (auto year = book.getPublicationYear()) {
+    appendNumber(*year, buffer_);
+  }
+  buffer_ += ',';
+  appendCsvField(book.getCategory(), buffer_);
+  buffer_ += ',';
+  buffer_ += statusName(book.getStatus());
+  buffer_ += '\n';
+}
+
+void CatalogExporter::appendJson(const BookView& book) {
+  buffer_ += "{\"id\":";
+  appendNumber(book.getBookID(), buffer_);
+  buffer_ += ",\"title\":";
+  appendJsonString(book.getTitle(), buffer_);
+  buffer_ += ",\"author\":";
+  appendJsonString(book.getAuthor(), buffer_);
+  buffer_ += ",\"isbn\":";
+  appendJsonString(book.getISBN(), buffer_);
+  buffer_ += ",\"year\":";
+  if (auto year = book.getPublicationYear()) {
+    appendNumber(*year, buffer_);
+  } else {
+    buffer_ += "null";
+  }
+  buffer_ += ",\"category\":";
+  appendJsonString(book.getCategory(), buffer_);
+  buffer_ += ",\"status\":\"";
+  buffer_ += statusName(book.getStatus());
+  buffer_ += "\"}\n";
+}
+
+void CatalogExporter::flush(std::ostream& out, ExportStats& stats) {
+  if (buffer_.empty()) {
+    return;
+  }
+
+  out.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+  if (!out) {
+    throw std::runtime_error("catalog export failed");
+  }
+  stats.bytes += buffer_.size();
+  buffer_.clear();
+}
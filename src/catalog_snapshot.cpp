@@ -0,0 +1,34 @@
+#include "../include/catalog_snapshot.h"
+
+CatalogSnapshot::CatalogSnapshot(BookTable books, size_t available_books, uint64_t sequence)
+    : books_(std::move(books)), available_books_(available_books), sequence_(sequence) {
+}
+
+std::optional<Book> CatalogSnapshot::getBook(unsigned int book_id) const {
+  auto book = books_.find(book_id);
+  if (!book) {
+    return std::nullopt;
+  }
+  return book->toBook();
+}
+
+std::vector<Book> CatalogSnapshot::getAllBooks() const {
+  std::vector<Book> result;
+  result.reserve(books_.size());
+
+  books_.forEach([&result](const BookView& book) { result.push_back(book.toBook()); });
+
+  return result;
+}
+
+size_t CatalogSnapshot::getTotalBooks() const {
+  return books_.size();
+}
+
+size_t CatalogSnapshot::getAvailableBooks() const {
+  return available_books_;
+}
+
+uint64_t CatalogSnapshot::getSequence() const {
+  return sequence_;
+}
@@ -0,0 +1,74 @@
+#include "../include/change_feed.h"
+
+#include <algorithm>
+
+ChangeFeed::ChangeFeed(size_t capacity) : ring_(std::max<size_t>(capacity, 1)) {
+}
+
+void ChangeFeed::append(ChangeEvent event) {
+  {
+    std::lock_guard lock(mutex_);
+    // A gap (e.g. after a catalog reload) invalidates everything retained so far
+    if (first_sequence_ == 0 || event.sequence != last_sequence_ + 1) {
+      first_sequence_ = event.sequence;
+    }
+    last_sequence_ = event.sequence;
+    ring_[last_sequence_ % ring_.size()] = std::move(event);
+  }
+  appended_.notify_all();
+}
+
+ChangeBatch ChangeFeed::pull(uint64_t from_sequence, size_t max_events) const {
+  std::lock_guard lock(mutex_);
+  ChangeBatch batch;
+
+  uint64_t first = std::max<uint64_t>(from_sequence, 1);
+  if (first > last_sequence_ || max_events == 0) {
+    batch.next_sequence = first;
+    return batch;
+  }
+
+  uint64_t oldest = oldestRetained();
+  if (first < oldest) {
+    batch.overrun = true;
+    first = oldest;
+  }
+
+  uint64_t last = std::min<uint64_t>(last_sequence_, first + max_events - 1);
+
+  batch.events.reserve(last - first + 1);
+  for (uint64_t sequence = first; sequence <= last; ++sequence) {
+    batch.events.push_back(ring_[sequence % ring_.size()]);
+  }
+  batch.next_sequence = last + 1;
+  return batch;
+}
+
+bool ChangeFeed::waitFor(uint64_t sequence, std::chrono::milliseconds timeout) const {
+  std::unique_lock lock(mutex_);
+  return appended_.wait_for(lock, timeout, [&] { return last_sequence_ >= sequence; });
+}
+
+uint64_t ChangeFeed::lastSequence() const {
+  std::lock_guard lock(mutex_);
+  return last_sequence_;
+}
+
+uint64_t ChangeFeed::oldestSequence() const {
+  std::lock_guard lock(mutex_);
+  return oldestRetained();
+}
+
+size_t ChangeFeed::capacity() const {
+  return ring_.size();
+}
+
+uint64_t ChangeFeed::oldestRetained() const {
+  if (first_sequence_ == 0) {
+    return last_sequence_ + 1;
+  }
+  if (last_sequence_ - first_sequence_ < ring_.size()) {
+    return first_sequence_;
+  }
+  return last_sequence_ - ring_.size() + 1;
+}
@@ -1,5 +1,7 @@
 #include "../include/console_ui.h"
+#include "../include/catalog_exporter.h"
 
+#include <fstream>
 #include <iostream>
 #include <limits>
 #include <print>
@@ -42,6 +44,9 @@ void ConsoleUI::run() {
     case 9:
       handleStatistics();
       break;
+    case 10:
+      handleExport();
+      break;
     case 0:
       std::println("Thank you for using the Library Management System!");
       return;
@@ -69,6 +74,7 @@ void ConsoleUI::displayMenu() {
   std::println("║  7. Borrow Book                        ║");
   std::println("║  8. Return Book                        ║");
   std::println("║  9. View Statistics                    ║");
+  std::println("║ 10. Export Catalog                     ║");
   std::println("║  0. Exit                               ║");
   std::println("╚════════════════════════════════════════╝");
 }
@@ -172,6 +178,7 @@ void ConsoleUI::handleSearchBooks() {
   std::println("1. Search by title");
   std::println("2. Search by author");
   std::println("3. Search by category");
+  std::println("4. Best matches (title and author)");
 
   int choice = readInt("\nEnter your choice: ");
   std::vector<Book> results;
@@ -192,6 +199,11 @@ void ConsoleUI::handleSearchBooks() {
     results = manager_.searchByCategory(category);
     break;
   }
+  case 4: {
+    std::string query = readLine("Enter search terms: ");
+    results = manager_.searchRanked(query);
+    break;
+  }
   default:
     std::println("Invalid choice!");
     return;
@@ -240,6 +252,51 @@ void ConsoleUI::handleStatistics() {
   std::println("Borrowed books:  {}", manager_.getTotalBooks() - manager_.getAvailableBooks());
 }
 
+void ConsoleUI::handleExport() {
+  std::println("=== EXPORT CATALOG ===");
+  std::println("1. CSV");
+  std::println("2. JSON Lines");
+
+  ExportOptions options;
+  int format = readInt("\nEnter format: ");
+  if (format != 1 && format != 2) {
+    std::println("Invalid choice!");
+    return;
+  }
+  options.format = format == 1 ? ExportFormat::Csv : ExportFormat::JsonLines;
+
+  std::string path = readLine("Enter output file: ");
+  std::string category = readLine("Only this category (press Enter for all): ");
+  if (!category.empty()) {
+    options.category = category;
+  }
+  int status = readInt("Only status (0 = all, 1 = available, 2 = borrowed): ");
+  if (status == 1) {
+    options.status = BookStatus::Available;
+  } else if (status == 2) {
+    options.status = BookStatus::Borrowed;
+  }
+
+  std::ofstream out(path, std::ios::binary);
+  if (!out) {
+    std::println("\n✗ Cannot open {}!", path);
+    return;
+  }
+
+  try {
+    CatalogExporter exporter(options);
+    ExportStats stats = exporter.write(manager_.snapshot(), out);
+    std::println("\n✓ Exported {} book(s), {:.1f} MB in {:.3f} s ({:.0f} rows/s, {:.1f} MB/s)",
+                 stats.rows,
+                 static_cast<double>(stats.bytes) / (1024.0 * 1024.0),
+                 stats.seconds,
+                 stats.rowsPerSecond(),
+                 stats.megabytesPerSecond());
+  } catch (const std::exception& error) {
+    std::println("\n✗ Export failed: {}", error.what());
+  }
+}
+
 void ConsoleUI::displayBook(const Book& book) {
   std::println("Book ID:    {}", book.getBookID());
   std::println("Title:      {}", book.getTitle());
@@ -1,106 +1,193 @@
 #include "../include/library_manager.h"
+#include "../include/memory_usage.h"
 #include <algorithm>
 
+namespace {
+
+size_t statusIndex(BookStatus status) {
+  return static_cast<size_t>(status);
+}
+
+std::optional<unsigned int> decadeOf(std::optional<unsigned int> year) {
+  if (!year) {
+    return std::nullopt;
+  }
+  return *year / 10 * 10;
+}
+
+} // namespace
+
 unsigned int LibraryManager::addBook(std::string_view title, 
                                       std::string_view author,
                                       std::string_view isbn,
                                       std::optional<unsigned int> publication_year,
                                       std::string_view category) {
-  unsigned int book_id = next_book_id_++;
-  Book book(book_id, title, author, isbn, publication_year, category);
-  books_[book_id] = std::move(book);
+  unsigned int book_id = allocateBookID();
+  insertBook(Book(book_id, title, author, isbn, publication_year, category));
+  invalidate({CatalogField::Membership});
+  recordChange(ChangeType::Add, book_id, books_.find(book_id));
   return book_id;
 }
 
 bool LibraryManager::removeBook(unsigned int book_id) {
-  return books_.erase(book_id) > 0;
+  auto book = books_.find(book_id);
+  if (!book) {
+    return false;
+  }
+
+  unindexFacets(*book);
+  search_index_.removeDocument(book_id, book->getTitle(), book->getAuthor());
+  books_.erase(book_id);
+  if (id_policy_ == IdPolicy::ReuseRetired) {
+    free_ids_.add(book_id);
+  }
+  invalidate({CatalogField::Membership});
+  recordChange(ChangeType::Remove, book_id);
+  return true;
 }
 
 bool LibraryManager::updateBook(unsigned int book_id, 
                                  std::string_view title, 
                                  std::string_view author) {
-  auto it = books_.find(book_id);
-  if (it == books_.end()) {
+  auto book = books_.find(book_id);
+  if (!book) {
     return false;
   }
   
-  it->second.setTitle(title);
-  it->second.setAuthor(author);
+  Book previous = book->toBook();
+  Book updated = previous;
+  updated.setTitle(title);
+  updated.setAuthor(author);
+  books_.insert(updated);
+  search_index_.removeDocument(book_id, previous.getTitle(), previous.getAuthor());
+  search_index_.addDocument(book_id, title, author);
+  invalidate({CatalogField::Title, CatalogField::Author});
+  recordChange(ChangeType::Update, book_id, books_.find(book_id));
   return true;
 }
 
 std::optional<Book> LibraryManager::getBook(unsigned int book_id) const {
-  auto it = books_.find(book_id);
-  if (it == books_.end()) {
+  auto book = books_.find(book_id);
+  if (!book) {
     return std::nullopt;
   }
-  return it->second;
+  return book->toBook();
 }
 
 std::vector<Book> LibraryManager::getAllBooks() const {
   std::vector<Book> result;
   result.reserve(books_.size());
   
-  for (const auto& [id, book] : books_) {
-    result.push_back(book);
-  }
+  books_.forEach([&result](const BookView& book) { result.push_back(book.toBook()); });
   
   return result;
 }
 
 std::vector<Book> LibraryManager::searchByTitle(std::string_view title) const {
+  std::string key = "title:" + std::string(title);
+  if (auto cached = cachedBooks(key)) {
+    return std::move(*cached);
+  }
+
   std::vector<Book> result;
   
-  for (const auto& [id, book] : books_) {
-    if (book.getTitle().find(title) != std::string::npos) {
-      result.push_back(book);
+  books_.forEach([&](const BookView& book) {
+    if (book.getTitle().find(title) != std::string_view::npos) {
+      result.push_back(book.toBook());
     }
-  }
+  });
+  
+  cacheBooks(std::move(key), result, {CatalogField::Membership, CatalogField::Title});
   
   return result;
 }
 
 std::vector<Book> LibraryManager::searchByAuthor(std::string_view author) const {
+  std::string key = "author:" + std::string(author);
+  if (auto cached = cachedBooks(key)) {
+    return std::move(*cached);
+  }
+
   std::vector<Book> result;
   
-  for (const auto& [id, book] : books_) {
-    if (book.getAuthor().find(author) != std::string::npos) {
-      result.push_back(book);
+  books_.forEach([&](const BookView& book) {
+    if (book.getAuthor().find(author) != std::string_view::npos) {
+      result.push_back(book.toBook());
     }
-  }
+  });
+  
+  cacheBooks(std::move(key), result, {CatalogField::Membership, CatalogField::Author});
   
   return result;
 }
 
 std::vector<Book> LibraryManager::searchByCategory(std::string_view category) const {
+  std::string key = "category:" + std::string(category);
+  if (auto cached = cachedBooks(key)) {
+    return std::move(*cached);
+  }
+
   std::vector<Book> result;
   
-  for (const auto& [id, book] : books_) {
+  books_.forEach([&](const BookView& book) {
     if (book.getCategory() == category) {
-      result.push_back(book);
+      result.push_back(book.toBook());
     }
-  }
+  });
+  
+  cacheBooks(std::move(key), result, {CatalogField::Membership, CatalogField::Category});
   
   return result;
 }
 
+std::vector<Book> LibraryManager::searchRanked(std::string_view query, size_t k) const {
+  // Ranking only depends on the set of distinct tokens
+  auto terms = SearchIndex::tokenize(query);
+  std::sort(terms.begin(), terms.end());
+  terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+  std::string key = "ranked:" + std::to_string(k) + ":";
+  for (const auto& term : terms) {
+    key += term;
+    key += ' ';
+  }
+  if (auto cached = cachedBooks(key)) {
+    return std::move(*cached);
+  }
+
+  std::vector<Book> result;
+  auto hits = search_index_.search(query, k);
+  result.reserve(hits.size());
+
+  for (const auto& hit : hits) {
+    result.push_back(books_.find(hit.book_id)->toBook());
+  }
+
+  cacheBooks(std::move(key),
+             result,
+             {CatalogField::Membership, CatalogField::Title, CatalogField::Author});
+  return result;
+}
+
 bool LibraryManager::borrowBook(unsigned int book_id) {
-  auto it = books_.find(book_id);
-  if (it == books_.end() || !it->second.isAvailable()) {
+  auto book = books_.find(book_id);
+  if (!book || !book->isAvailable()) {
     return false;
   }
   
-  it->second.setStatus(BookStatus::Borrowed);
+  setStatus(book_id, BookStatus::Available, BookStatus::Borrowed);
+  recordChange(ChangeType::Borrow, book_id);
   return true;
 }
 
 bool LibraryManager::returnBook(unsigned int book_id) {
-  auto it = books_.find(book_id);
-  if (it == books_.end() || !it->second.isBorrowed()) {
+  auto book = books_.find(book_id);
+  if (!book || !book->isBorrowed()) {
     return false;
   }
   
-  it->second.setStatus(BookStatus::Available);
+  setStatus(book_id, BookStatus::Borrowed, BookStatus::Available);
+  recordChange(ChangeType::Return, book_id);
   return true;
 }
 
@@ -109,8 +196,327 @@ size_t LibraryManager::getTotalBooks() const {
 }
 
 size_t LibraryManager::getAvailableBooks() const {
-  return std::count_if(books_.begin(), books_.end(), 
-                       [](const auto& pair) { 
-                         return pair.second.isAvailable(); 
-                       });
+  return status_bitmaps_[statusIndex(BookStatus::Available)].cardinality();
+}
+
+CatalogSnapshot LibraryManager::snapshot() const {
+  return CatalogSnapshot(books_, getAvailableBooks(), change_sequence_);
+}
+
+void LibraryManager::enableQueryCache(size_t capacity) {
+  query_cache_.emplace(capacity);
+}
+
+void LibraryManager::disableQueryCache() {
+  query_cache_.reset();
+}
+
+QueryCacheStats LibraryManager::getQueryCacheStats() const {
+  return query_cache_ ? query_cache_->getStats() : QueryCacheStats{};
+}
+
+void LibraryManager::enableChangeFeed(size_t capacity) {
+  change_feed_ = std::make_shared<ChangeFeed>(capacity);
+}
+
+std::shared_ptr<const ChangeFeed> LibraryManager::getChangeFeed() const {
+  return change_feed_;
+}
+
+uint64_t LibraryManager::getChangeSequence() const {
+  return change_sequence_;
+}
+
+void LibraryManager::setIdPolicy(IdPolicy policy) {
+  id_policy_ = policy;
+  rebuildFreeIDs();
+}
+
+IdPolicy LibraryManager::getIdPolicy() const {
+  return id_policy_;
+}
+
+CompactionReport LibraryManager::compact() {
+  CompactionReport report;
+  report.before = getMemoryUsage();
+
+  books_.compact();
+
+  if (id_policy_ == IdPolicy::ReuseRetired) {
+    // Handing out trailing IDs from next_book_id_ is equivalent and needs no free list
+    auto last = books_.lastBookID();
+    next_book_id_ = last ? *last + 1 : 1;
+    while (auto highest = free_ids_.maximum()) {
+      if (*highest < next_book_id_) {
+        break;
+      }
+      free_ids_.remove(*highest);
+    }
+    free_ids_.shrinkToFit();
+  }
+
+  for (auto& [category, bitmap] : category_bitmaps_) {
+    bitmap.shrinkToFit();
+  }
+  for (auto& bitmap : status_bitmaps_) {
+    bitmap.shrinkToFit();
+  }
+  for (auto& [decade, bitmap] : decade_bitmaps_) {
+    bitmap.shrinkToFit();
+  }
+  search_index_.compact();
+
+  report.after = getMemoryUsage();
+  return report;
+}
+
+CatalogMemoryUsage LibraryManager::getMemoryUsage() const {
+  CatalogMemoryUsage usage;
+  BookTableMemoryUsage table = books_.memoryUsage();
+  usage.books = books_.size();
+  usage.book_records = table.records;
+  usage.book_strings = table.strings;
+  usage.string_garbage = table.string_garbage;
+
+  usage.facet_indexes = heapBytes(category_bitmaps_) + heapBytes(decade_bitmaps_);
+  for (const auto& [category, bitmap] : category_bitmaps_) {
+    usage.facet_indexes += heapBytes(category) + bitmap.memoryUsage();
+  }
+  for (const auto& bitmap : status_bitmaps_) {
+    usage.facet_indexes += bitmap.memoryUsage();
+  }
+  for (const auto& [decade, bitmap] : decade_bitmaps_) {
+    usage.facet_indexes += bitmap.memoryUsage();
+  }
+
+  usage.search_index = search_index_.memoryUsage();
+  usage.query_cache = query_cache_ ? query_cache_->memoryUsage() : 0;
+  usage.free_ids = free_ids_.memoryUsage();
+  return usage;
+}
+
+void LibraryManager::loadCatalog(const std::vector<Book>& books, uint64_t sequence) {
+  books_ = BookTable();
+  category_bitmaps_.clear();
+  status_bitmaps_ = {};
+  decade_bitmaps_.clear();
+  search_index_ = SearchIndex();
+  if (query_cache_) {
+    query_cache_->clear();
+  }
+
+  for (const auto& book : books) {
+    next_book_id_ = std::max(next_book_id_, book.getBookID() + 1);
+    insertBook(book);
+  }
+  rebuildFreeIDs();
+  change_sequence_ = sequence;
+}
+
+void LibraryManager::applyChange(const ChangeEvent& event) {
+  // The regular operations record the change under the next sequence number
+  change_sequence_ = event.sequence - 1;
+
+  switch (event.type) {
+  case ChangeType::Add:
+    if (event.book) {
+      unsigned int book_id = event.book->getBookID();
+      if (books_.contains(book_id)) {
+        (void)removeBook(book_id);
+        change_sequence_ = event.sequence - 1;
+      }
+      // The primary may hand out IDs this side still considers free
+      free_ids_.remove(book_id);
+      next_book_id_ = std::max(next_book_id_, book_id + 1);
+      insertBook(*event.book);
+      invalidate({CatalogField::Membership});
+      recordChange(ChangeType::Add, book_id, books_.find(book_id));
+    }
+    break;
+  case ChangeType::Remove:
+    (void)removeBook(event.book_id);
+    break;
+  case ChangeType::Update:
+    if (event.book) {
+      (void)updateBook(event.book_id, event.book->getTitle(), event.book->getAuthor());
+    }
+    break;
+  case ChangeType::Borrow:
+    (void)borrowBook(event.book_id);
+    break;
+  case ChangeType::Return:
+    (void)returnBook(event.book_id);
+    break;
+  }
+
+  change_sequence_ = event.sequence;
+}
+
+FacetCounts LibraryManager::getFacetCounts() const {
+  FacetCounts counts;
+
+  for (const auto& [category, bitmap] : category_bitmaps_) {
+    counts.by_category[category] = bitmap.cardinality();
+  }
+  for (size_t i = 0; i < kStatusCount; ++i) {
+    if (!status_bitmaps_[i].empty()) {
+      counts.by_status[static_cast<BookStatus>(i)] = status_bitmaps_[i].cardinality();
+    }
+  }
+  for (const auto& [decade, bitmap] : decade_bitmaps_) {
+    counts.by_decade[decade] = bitmap.cardinality();
+  }
+
+  return counts;
+}
+
+FacetCounts LibraryManager::getFacetCounts(const std::vector<Book>& results) const {
+  RoaringBitmap result_ids;
+  for (const auto& book : results) {
+    result_ids.add(book.getBookID());
+  }
+  return getFacetCounts(result_ids);
+}
+
+FacetCounts LibraryManager::getFacetCounts(const RoaringBitmap& result_ids) const {
+  FacetCounts counts;
+
+  for (const auto& [category, bitmap] : category_bitmaps_) {
+    if (size_t count = bitmap.intersectionCardinality(result_ids); count > 0) {
+      counts.by_category[category] = count;
+    }
+  }
+  for (size_t i = 0; i < kStatusCount; ++i) {
+    if (size_t count = status_bitmaps_[i].intersectionCardinality(result_ids); count > 0) {
+      counts.by_status[static_cast<BookStatus>(i)] = count;
+    }
+  }
+  for (const auto& [decade, bitmap] : decade_bitmaps_) {
+    if (size_t count = bitmap.intersectionCardinality(result_ids); count > 0) {
+      counts.by_decade[decade] = count;
+    }
+  }
+
+  return counts;
+}
+
+unsigned int LibraryManager::allocateBookID() {
+  if (auto book_id = free_ids_.minimum()) {
+    free_ids_.remove(*book_id);
+    return *book_id;
+  }
+  return next_book_id_++;
+}
+
+void LibraryManager::rebuildFreeIDs() {
+  free_ids_.clear();
+  if (id_policy_ != IdPolicy::ReuseRetired) {
+    return;
+  }
+  for (unsigned int book_id = 1; book_id < next_book_id_; ++book_id) {
+    if (!books_.contains(book_id)) {
+      free_ids_.add(book_id);
+    }
+  }
+}
+
+void LibraryManager::insertBook(const Book& book) {
+  // Storing the text may throw, so index only once the table holds the book
+  books_.insert(book);
+  indexFacets(book);
+  search_index_.addDocument(book.getBookID(), book.getTitle(), book.getAuthor());
+}
+
+void LibraryManager::indexFacets(const Book& book) {
+  unsigned int book_id = book.getBookID();
+
+  category_bitmaps_[book.getCategory()].add(book_id);
+  status_bitmaps_[statusIndex(book.getStatus())].add(book_id);
+  if (auto decade = decadeOf(book.getPublicationYear())) {
+    decade_bitmaps_[*decade].add(book_id);
+  }
+}
+
+void LibraryManager::unindexFacets(const BookView& book) {
+  unsigned int book_id = book.getBookID();
+
+  if (auto it = category_bitmaps_.find(book.getCategory()); it != category_bitmaps_.end()) {
+    it->second.remove(book_id);
+    if (it->second.empty()) {
+      category_bitmaps_.erase(it);
+    }
+  }
+  status_bitmaps_[statusIndex(book.getStatus())].remove(book_id);
+  if (auto decade = decadeOf(book.getPublicationYear())) {
+    if (auto it = decade_bitmaps_.find(*decade); it != decade_bitmaps_.end()) {
+      it->second.remove(book_id);
+      if (it->second.empty()) {
+        decade_bitmaps_.erase(it);
+      }
+    }
+  }
+}
+
+void LibraryManager::setStatus(unsigned int book_id, BookStatus from, BookStatus to) {
+  status_bitmaps_[statusIndex(from)].remove(book_id);
+  books_.setStatus(book_id, to);
+  status_bitmaps_[statusIndex(to)].add(book_id);
+  invalidate({CatalogField::Status});
+}
+
+void LibraryManager::invalidate(std::initializer_list<CatalogField> fields) {
+  if (!query_cache_) {
+    return;
+  }
+  for (CatalogField field : fields) {
+    query_cache_->bump(field);
+  }
+}
+
+void LibraryManager::recordChange(ChangeType type,
+                                  unsigned int book_id,
+                                  std::optional<BookView> book) {
+  ++change_sequence_;
+  if (!change_feed_) {
+    return;
+  }
+
+  ChangeEvent event{change_sequence_, type, book_id, std::nullopt};
+  if (book) {
+    event.book = book->toBook();
+  }
+  change_feed_->append(std::move(event));
+}
+
+std::optional<std::vector<Book>> LibraryManager::cachedBooks(std::string_view key) const {
+  if (!query_cache_) {
+    return std::nullopt;
+  }
+
+  const QueryCache::Value* value = query_cache_->lookup(key);
+  if (value == nullptr) {
+    return std::nullopt;
+  }
+
+  std::vector<Book> result;
+  result.reserve(value->size());
+  for (unsigned int book_id : *value) {
+    result.push_back(books_.find(book_id)->toBook());
+  }
+  return result;
+}
+
+void LibraryManager::cacheBooks(std::string key,
+                                const std::vector<Book>& books,
+                                std::initializer_list<CatalogField> depends_on) const {
+  if (!query_cache_) {
+    return;
+  }
+
+  std::vector<unsigned int> ids;
+  ids.reserve(books.size());
+  for (const auto& book : books) {
+    ids.push_back(book.getBookID());
+  }
+  query_cache_->store(std::move(key), std::move(ids), depends_on);
 }
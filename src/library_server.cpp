@@ -0,0 +1,351 @@
+#include "../include/library_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+
+constexpr size_t kMaxRequestSize = 64 * 1024;
+
+[[noreturn]] void throwSystemError(const char* what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+void closeIfOpen(int fd) {
+  if (fd >= 0) {
+    ::close(fd);
+  }
+}
+
+} // namespace
+
+LibraryServer::LibraryServer(LibraryManager& manager, std::string_view host, uint16_t port)
+    : handler_(manager) {
+  try {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (::inet_pton(AF_INET, std::string(host).c_str(), &address.sin_addr) != 1) {
+      throw std::invalid_argument("invalid listen address");
+    }
+
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+      throwSystemError("socket");
+    }
+
+    int reuse = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+      throwSystemError("bind");
+    }
+    if (::listen(listen_fd_, SOMAXCONN) < 0) {
+      throwSystemError("listen");
+    }
+
+    socklen_t length = sizeof(address);
+    if (::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length) < 0) {
+      throwSystemError("getsockname");
+    }
+    port_ = ntohs(address.sin_port);
+
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+      throwSystemError("epoll_create1");
+    }
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+      throwSystemError("eventfd");
+    }
+
+    for (int fd : {listen_fd_, wake_fd_}) {
+      epoll_event event{};
+      event.events = EPOLLIN;
+      event.data.fd = fd;
+      if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+        throwSystemError("epoll_ctl");
+      }
+    }
+  } catch (...) {
+    closeIfOpen(wake_fd_);
+    closeIfOpen(epoll_fd_);
+    closeIfOpen(listen_fd_);
+    throw;
+  }
+}
+
+LibraryServer::~LibraryServer() {
+  for (const auto& [fd, connection] : connections_) {
+    ::close(fd);
+  }
+  closeIfOpen(wake_fd_);
+  closeIfOpen(epoll_fd_);
+  closeIfOpen(listen_fd_);
+}
+
+uint16_t LibraryServer::port() const {
+  return port_;
+}
+
+void LibraryServer::run() {
+  std::array<epoll_event, kMaxEvents> events{};
+  bool stopping = false;
+
+  while (!stopping) {
+    int count = ::epoll_wait(epoll_fd_, events.data(), kMaxEvents, tick_interval_ms_);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throwSystemError("epoll_wait");
+    }
+
+    for (int i = 0; i < count; ++i) {
+      int fd = events[i].data.fd;
+      uint32_t ready = events[i].events;
+
+      if (fd == wake_fd_) {
+        uint64_t value = 0;
+        [[maybe_unused]] ssize_t ignored = ::read(wake_fd_, &value, sizeof(value));
+        stopping = true;
+      } else if (fd == listen_fd_) {
+        acceptConnections();
+      } else if (auto watched = watched_.find(fd); watched != watched_.end()) {
+        // Copied because the handler may unwatch itself
+        auto handler = watched->second;
+        handler();
+      } else if (ready & EPOLLERR) {
+        closeConnection(fd);
+      } else {
+        if (ready & (EPOLLIN | EPOLLHUP | EPOLLRDHUP)) {
+          handleReadable(fd);
+        }
+        if ((ready & EPOLLOUT) && connections_.contains(fd)) {
+          handleWritable(fd);
+        }
+      }
+    }
+
+    if (tick_handler_) {
+      tick_handler_();
+    }
+  }
+
+  while (!connections_.empty()) {
+    closeConnection(connections_.begin()->first);
+  }
+}
+
+void LibraryServer::stop() {
+  uint64_t one = 1;
+  [[maybe_unused]] ssize_t ignored = ::write(wake_fd_, &one, sizeof(one));
+}
+
+void LibraryServer::watch(int fd, std::function<void()> handler) {
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+  if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+    throwSystemError("epoll_ctl");
+  }
+  watched_[fd] = std::move(handler);
+}
+
+void LibraryServer::unwatch(int fd) {
+  if (watched_.erase(fd) > 0) {
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  }
+}
+
+void LibraryServer::setTickHandler(std::function<void()> handler,
+                                   std::chrono::milliseconds interval) {
+  tick_handler_ = std::move(handler);
+  tick_interval_ms_ = tick_handler_ ? static_cast<int>(interval.count()) : -1;
+}
+
+void LibraryServer::setReadOnly(bool read_only) {
+  handler_.setReadOnly(read_only);
+}
+
+void LibraryServer::setLagSource(std::function<uint64_t()> lag) {
+  handler_.setLagSource(std::move(lag));
+}
+
+size_t LibraryServer::peakPendingOutput() const {
+  return peak_pending_output_.load(std::memory_order_relaxed);
+}
+
+void LibraryServer::acceptConnections() {
+  while (true) {
+    int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      // EAGAIN means the backlog is drained; other errors only affect this client
+      return;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.fd = fd;
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+      ::close(fd);
+      continue;
+    }
+    connections_[fd].events = event.events;
+  }
+}
+
+void LibraryServer::handleReadable(int fd) {
+  auto it = connections_.find(fd);
+  if (it == connections_.end()) {
+    return;
+  }
+  Connection& connection = it->second;
+
+  if (connection.reading && !connection.peer_closed) {
+    // One read per wakeup keeps a single busy client from starving the others
+    ssize_t received = ::read(fd, read_buffer_.data(), read_buffer_.size());
+
+    if (received > 0) {
+      connection.input.append(read_buffer_.data(), static_cast<size_t>(received));
+      processRequests(connection);
+    } else if (received == 0) {
+      connection.peer_closed = true;
+    } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+      closeConnection(fd);
+      return;
+    }
+  }
+
+  if (!flushAndResume(fd, connection)) {
+    closeConnection(fd);
+    return;
+  }
+  updateInterest(fd, connection);
+}
+
+void LibraryServer::handleWritable(int fd) {
+  Connection& connection = connections_.at(fd);
+  if (!flushAndResume(fd, connection)) {
+    closeConnection(fd);
+    return;
+  }
+  updateInterest(fd, connection);
+}
+
+void LibraryServer::processRequests(Connection& connection) {
+  auto pending = [&connection] { return connection.output.size() - connection.output_offset; };
+
+  // Stop at the output cap and leave the rest buffered until the client reads
+  size_t start = 0;
+  size_t newline;
+  while (pending() <= kMaxPendingOutput &&
+         (newline = connection.input.find('\n', start)) != std::string::npos) {
+    std::string_view line(connection.input.data() + start, newline - start);
+    handler_.handle(line, connection.output);
+    start = newline + 1;
+  }
+  connection.input.erase(0, start);
+
+  if (connection.input.size() > kMaxRequestSize &&
+      connection.input.find('\n') == std::string::npos) {
+    connection.output += "ERR request too long\n";
+    connection.input.clear();
+    connection.peer_closed = true;
+  }
+  if (pending() > kMaxPendingOutput) {
+    connection.reading = false;
+  }
+  if (pending() > peak_pending_output_.load(std::memory_order_relaxed)) {
+    peak_pending_output_.store(pending(), std::memory_order_relaxed);
+  }
+}
+
+// Flushes, then answers requests held back by the output cap for as long as
+// their responses can be sent right away
+bool LibraryServer::flushAndResume(int fd, Connection& connection) {
+  while (true) {
+    if (!flush(fd, connection)) {
+      return false;
+    }
+    if (!connection.reading || connection.output_offset < connection.output.size() ||
+        connection.input.find('\n') == std::string::npos) {
+      return true;
+    }
+    processRequests(connection);
+  }
+}
+
+bool LibraryServer::flush(int fd, Connection& connection) {
+  while (connection.output_offset < connection.output.size()) {
+    ssize_t sent = ::send(fd,
+                          connection.output.data() + connection.output_offset,
+                          connection.output.size() - connection.output_offset,
+                          MSG_NOSIGNAL);
+    if (sent > 0) {
+      connection.output_offset += static_cast<size_t>(sent);
+    } else if (sent < 0 && errno == EINTR) {
+      continue;
+    } else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    } else {
+      return false;
+    }
+  }
+
+  if (connection.output_offset == connection.output.size()) {
+    connection.output.clear();
+    connection.output_offset = 0;
+  } else if (connection.output_offset > connection.output.size() / 2) {
+    connection.output.erase(0, connection.output_offset);
+    connection.output_offset = 0;
+  }
+
+  if (connection.output.size() - connection.output_offset <= kMaxPendingOutput) {
+    connection.reading = true;
+  }
+  return true;
+}
+
+void LibraryServer::updateInterest(int fd, Connection& connection) {
+  bool pending_output = connection.output_offset < connection.output.size();
+  if (connection.peer_closed && !pending_output) {
+    closeConnection(fd);
+    return;
+  }
+
+  uint32_t events = 0;
+  if (connection.reading && !connection.peer_closed) {
+    events |= EPOLLIN | EPOLLRDHUP;
+  }
+  if (pending_output) {
+    events |= EPOLLOUT;
+  }
+  if (events == connection.events) {
+    return;
+  }
+
+  epoll_event event{};
+  event.events = events;
+  event.data.fd = fd;
+  if (::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) < 0) {
+    closeConnection(fd);
+    return;
+  }
+  connection.events = events;
+}
+
+void LibraryServer::closeConnection(int fd) {
+  ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  ::close(fd);
+  connections_.erase(fd);
+}
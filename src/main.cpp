@@ -1,20 +1,233 @@
 #include "console_ui.h"
 #include "library_manager.h"
+#ifdef LMS_HAS_SERVER
+#include "book_record.h"
+#include "catalog_exporter.h"
+#include "library_server.h"
+#include "replication.h"
 
+#include <poll.h>
+#endif
+
+#include <charconv>
+#include <exception>
+#include <fstream>
+#include <optional>
 #include <print>
+#include <string>
+#include <string_view>
+
+namespace {
+
+constexpr uint16_t kDefaultPort = 7070;
+
+void printUsage() {
+  std::println("Usage: lms                                     interactive console");
+  std::println("       lms --serve [port] [--publish <socket>]  serve the line protocol over TCP");
+  std::println("                                               (default port {}), optionally",
+               kDefaultPort);
+  std::println("                                               feeding replicas on a Unix socket");
+  std::println("       lms --replica <socket> [port]           serve reads from a replica of the");
+  std::println("                                               primary publishing on <socket>");
+  std::println("       lms --export csv|jsonl <path> --from <socket>");
+  std::println("           [--category <name>] [--status <name>]");
+  std::println("                                               write the catalog of the primary");
+  std::println("                                               publishing on <socket> to a file");
+}
+
+#ifdef LMS_HAS_SERVER
+constexpr auto kPublishInterval = std::chrono::milliseconds(50);
+constexpr int kExportIdleTimeoutMs = 10000;
+
+std::optional<uint16_t> parsePort(std::string_view arg) {
+  uint16_t port = 0;
+  auto [end, error] = std::from_chars(arg.data(), arg.data() + arg.size(), port);
+  if (error != std::errc() || end != arg.data() + arg.size()) {
+    return std::nullopt;
+  }
+  return port;
+}
+
+int runPrimary(LibraryManager& manager, int argc, char* argv[]) {
+  uint16_t port = kDefaultPort;
+  std::string_view publish_path;
+  for (int i = 2; i < argc; ++i) {
+    std::string_view arg(argv[i]);
+    if (arg == "--publish" && i + 1 < argc) {
+      publish_path = argv[++i];
+    } else if (auto parsed = parsePort(arg)) {
+      port = *parsed;
+    } else {
+      printUsage();
+      return 1;
+    }
+  }
+
+  try {
+    LibraryServer server(manager, "0.0.0.0", port);
+    std::optional<ReplicationPublisher> publisher;
+    if (!publish_path.empty()) {
+      publisher.emplace(manager, publish_path);
+      server.watch(publisher->fd(), [&publisher] { publisher->handleEvents(); });
+      server.setTickHandler([&publisher] { publisher->publish(); }, kPublishInterval);
+      std::println("Publishing changes on {}", publish_path);
+    }
+
+    std::println("Serving on port {}", server.port());
+    server.run();
+  } catch (const std::exception& error) {
+    // e.g. the port is already in use
+    std::println("Server failed: {}", error.what());
+    return 1;
+  }
+  return 0;
+}
+
+int runReplica(LibraryManager& manager, int argc, char* argv[]) {
+  if (argc < 3 || argc > 4) {
+    printUsage();
+    return 1;
+  }
+  uint16_t port = kDefaultPort;
+  if (argc == 4) {
+    auto parsed = parsePort(argv[3]);
+    if (!parsed) {
+      printUsage();
+      return 1;
+    }
+    port = *parsed;
+  }
 
-auto main() -> int {
+  try {
+    ReplicationClient client(manager, argv[2]);
+    LibraryServer server(manager, "0.0.0.0", port);
+    server.setReadOnly(true);
+    server.setLagSource([&client] { return client.lag(); });
+    server.watch(client.fd(), [&client, &server] {
+      if (!client.poll()) {
+        // Keep serving the last state received
+        server.unwatch(client.fd());
+        std::println("Lost connection to primary at sequence {}", client.appliedSequence());
+      }
+    });
+
+    std::println("Replicating from {}, serving on port {}", argv[2], server.port());
+    server.run();
+  } catch (const std::exception& error) {
+    // e.g. no primary is publishing on the socket yet
+    std::println("Replica failed: {}", error.what());
+    return 1;
+  }
+  return 0;
+}
+// Receives a snapshot from the primary like a replica does, then exports it
+int runExport(LibraryManager& manager, int argc, char* argv[]) {
+  auto format = argc >= 4 ? CatalogExporter::parseFormat(argv[2]) : std::nullopt;
+  if (!format) {
+    printUsage();
+    return 1;
+  }
+  std::string_view path = argv[3];
+
+  ExportOptions options;
+  options.format = *format;
+  std::string_view socket_path;
+  for (int i = 4; i + 1 < argc; i += 2) {
+    std::string_view arg(argv[i]);
+    bool valid = true;
+    if (arg == "--from") {
+      socket_path = argv[i + 1];
+    } else if (arg == "--category") {
+      options.category = argv[i + 1];
+    } else if (arg == "--status") {
+      options.status = parseStatus(argv[i + 1]);
+      valid = options.status.has_value();
+    } else {
+      valid = false;
+    }
+    if (!valid) {
+      printUsage();
+      return 1;
+    }
+  }
+  if (socket_path.empty() || (argc - 4) % 2 != 0) {
+    printUsage();
+    return 1;
+  }
+
+  try {
+    ReplicationClient client(manager, socket_path);
+    while (!client.isBootstrapped()) {
+      pollfd ready{client.fd(), POLLIN, 0};
+      if (::poll(&ready, 1, kExportIdleTimeoutMs) == 0) {
+        std::println("No snapshot from {}", socket_path);
+        return 1;
+      }
+      if (!client.poll()) {
+        std::println("Lost connection to primary at {}", socket_path);
+        return 1;
+      }
+    }
+
+    std::ofstream out(std::string(path), std::ios::binary);
+    if (!out) {
+      std::println("Cannot open {}", path);
+      return 1;
+    }
+    CatalogExporter exporter(options);
+    ExportStats stats = exporter.write(manager.snapshot(), out);
+    std::println("Exported {} book(s) at sequence {}, {:.1f} MB in {:.3f} s "
+                 "({:.0f} rows/s, {:.1f} MB/s)",
+                 stats.rows,
+                 client.appliedSequence(),
+                 static_cast<double>(stats.bytes) / (1024.0 * 1024.0),
+                 stats.seconds,
+                 stats.rowsPerSecond(),
+                 stats.megabytesPerSecond());
+  } catch (const std::exception& error) {
+    std::println("Export failed: {}", error.what());
+    return 1;
+  }
+  return 0;
+}
+#endif
+
+} // namespace
+
+auto main(int argc, char* argv[]) -> int {
   std::println("Library Management System v0.1\n");
 
   LibraryManager manager;
-  ConsoleUI ui(manager);
+  std::string_view mode = argc > 1 ? std::string_view(argv[1]) : "";
 
-  manager.addBook(
-      "The C++ Programming Language", "Bjarne Stroustrup", "978-0321563842", 2013, "Programming");
-  manager.addBook("Effective Modern C++", "Scott Meyers", "978-1491903995", 2014, "Programming");
-  manager.addBook(
-      "Design Patterns", "Gang of Four", "978-0201633610", 1994, "Software Engineering");
+  // A replica's catalog, like an exported one, comes entirely from its primary
+  if (mode != "--replica" && mode != "--export") {
+    (void)manager.addBook(
+        "The C++ Programming Language", "Bjarne Stroustrup", "978-0321563842", 2013, "Programming");
+    (void)manager.addBook(
+        "Effective Modern C++", "Scott Meyers", "978-1491903995", 2014, "Programming");
+    (void)manager.addBook(
+        "Design Patterns", "Gang of Four", "978-0201633610", 1994, "Software Engineering");
+  }
 
+  if (mode == "--serve" || mode == "--replica" || mode == "--export") {
+#ifdef LMS_HAS_SERVER
+    if (mode == "--export") {
+      return runExport(manager, argc, argv);
+    }
+    return mode == "--serve" ? runPrimary(manager, argc, argv) : runReplica(manager, argc, argv);
+#else
+    std::println("Server mode is not available on this platform.");
+    return 1;
+#endif
+  }
+
+  if (argc > 1) {
+    printUsage();
+    return 1;
+  }
+
+  ConsoleUI ui(manager);
   ui.run();
 
   return 0;
@@ -0,0 +1,96 @@
+#include "../include/query_cache.h"
+#include "../include/memory_usage.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+uint32_t fieldBit(CatalogField field) {
+  return uint32_t{1} << static_cast<size_t>(field);
+}
+
+} // namespace
+
+QueryCache::QueryCache(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {
+  stats_.capacity = capacity_;
+}
+
+const QueryCache::Value* QueryCache::lookup(std::string_view key) {
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++stats_.misses;
+    return nullptr;
+  }
+
+  if (!isFresh(*it->second)) {
+    erase(it->second);
+    ++stats_.invalidations;
+    ++stats_.misses;
+    return nullptr;
+  }
+
+  // Move to the front of the LRU list
+  entries_.splice(entries_.begin(), entries_, it->second);
+  ++stats_.hits;
+  return &entries_.front().value;
+}
+
+void QueryCache::store(std::string key,
+                       Value value,
+                       std::initializer_list<CatalogField> depends_on) {
+  if (auto it = index_.find(key); it != index_.end()) {
+    erase(it->second);
+  }
+
+  Entry entry{std::move(key), std::move(value), 0, generations_};
+  for (CatalogField field : depends_on) {
+    entry.field_mask |= fieldBit(field);
+  }
+
+  entries_.push_front(std::move(entry));
+  index_.emplace(entries_.front().key, entries_.begin());
+
+  while (entries_.size() > capacity_) {
+    erase(std::prev(entries_.end()));
+    ++stats_.evictions;
+  }
+}
+
+void QueryCache::bump(CatalogField field) {
+  ++generations_[static_cast<size_t>(field)];
+}
+
+void QueryCache::clear() {
+  index_.clear();
+  entries_.clear();
+}
+
+QueryCacheStats QueryCache::getStats() const {
+  QueryCacheStats stats = stats_;
+  stats.size = entries_.size();
+  return stats;
+}
+
+size_t QueryCache::memoryUsage() const {
+  // List nodes carry two links next to the entry
+  size_t bytes = heapBytes(index_) + entries_.size() * (sizeof(Entry) + 2 * sizeof(void*));
+  for (const auto& entry : entries_) {
+    bytes += heapBytes(entry.key) + heapBytes(entry.value);
+  }
+  return bytes;
+}
+
+bool QueryCache::isFresh(const Entry& entry) const {
+  for (size_t i = 0; i < kFieldCount; ++i) {
+    if ((entry.field_mask & (uint32_t{1} << i)) && entry.generations[i] != generations_[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void QueryCache::erase(std::list<Entry>::iterator it) {
+  index_.erase(it->key);
+  entries_.erase(it);
+}
@@ -0,0 +1,538 @@
+#include "../include/replication.h"
+
+#include "../include/book_record.h"
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+
+[[noreturn]] void throwSystemError(const char* what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+sockaddr_un socketAddress(std::string_view path) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+    throw std::invalid_argument("invalid replication socket path");
+  }
+  std::copy(path.begin(), path.end(), address.sun_path);
+  return address;
+}
+
+// Splits "word rest" at the first space
+std::pair<std::string_view, std::string_view> splitWord(std::string_view text) {
+  size_t space = text.find(' ');
+  if (space == std::string_view::npos) {
+    return {text, {}};
+  }
+  return {text.substr(0, space), text.substr(space + 1)};
+}
+
+std::string_view changeName(ChangeType type) {
+  switch (type) {
+  case ChangeType::Add:
+    return "ADD";
+  case ChangeType::Remove:
+    return "REMOVE";
+  case ChangeType::Update:
+    return "UPDATE";
+  case ChangeType::Borrow:
+    return "BORROW";
+  case ChangeType::Return:
+    return "RETURN";
+  }
+  return "UNKNOWN";
+}
+
+std::optional<ChangeType> parseChangeType(std::string_view name) {
+  for (auto type : {ChangeType::Add,
+                    ChangeType::Remove,
+                    ChangeType::Update,
+                    ChangeType::Borrow,
+                    ChangeType::Return}) {
+    if (changeName(type) == name) {
+      return type;
+    }
+  }
+  return std::nullopt;
+}
+
+} // namespace
+
+// ReplicationPublisher
+
+ReplicationPublisher::ReplicationPublisher(LibraryManager& manager, std::string_view socket_path)
+    : manager_(manager), socket_path_(socket_path) {
+  sockaddr_un address = socketAddress(socket_path);
+
+  if (!manager_.getChangeFeed()) {
+    manager_.enableChangeFeed(kDefaultFeedCapacity);
+  }
+  feed_ = manager_.getChangeFeed();
+
+  epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0) {
+    throwSystemError("epoll_create1");
+  }
+  listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (listen_fd_ < 0) {
+    int error = errno;
+    ::close(epoll_fd_);
+    throw std::system_error(error, std::generic_category(), "socket");
+  }
+
+  // A stale socket file from an earlier run would make bind fail
+  ::unlink(socket_path_.c_str());
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = listen_fd_;
+  if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+      ::listen(listen_fd_, SOMAXCONN) < 0 ||
+      ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event) < 0) {
+    int error = errno;
+    ::close(listen_fd_);
+    ::close(epoll_fd_);
+    throw std::system_error(error, std::generic_category(), "bind");
+  }
+}
+
+ReplicationPublisher::~ReplicationPublisher() {
+  for (const auto& [fd, replica] : replicas_) {
+    ::close(fd);
+  }
+  ::close(listen_fd_);
+  ::close(epoll_fd_);
+  ::unlink(socket_path_.c_str());
+}
+
+int ReplicationPublisher::fd() const {
+  return epoll_fd_;
+}
+
+void ReplicationPublisher::handleEvents() {
+  std::array<epoll_event, kMaxEvents> events;
+  int count = ::epoll_wait(epoll_fd_, events.data(), kMaxEvents, 0);
+  uint64_t head = manager_.getChangeSequence();
+
+  for (int i = 0; i < count; ++i) {
+    int fd = events[i].data.fd;
+    uint32_t ready = events[i].events;
+    if (fd == listen_fd_) {
+      acceptReplicas();
+      continue;
+    }
+
+    auto it = replicas_.find(fd);
+    if (it == replicas_.end()) {
+      continue;
+    }
+    // Replicas never send anything, so any input means the peer is gone
+    if ((ready & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) ||
+        !publishTo(fd, it->second, head)) {
+      dropReplica(fd);
+    }
+  }
+}
+
+void ReplicationPublisher::publish() {
+  uint64_t head = manager_.getChangeSequence();
+
+  std::vector<int> disconnected;
+  for (auto& [fd, replica] : replicas_) {
+    if (!publishTo(fd, replica, head)) {
+      disconnected.push_back(fd);
+    }
+  }
+  for (int fd : disconnected) {
+    dropReplica(fd);
+  }
+}
+
+size_t ReplicationPublisher::replicaCount() const {
+  return replicas_.size();
+}
+
+size_t ReplicationPublisher::pendingOutput() const {
+  size_t pending = 0;
+  for (const auto& [fd, replica] : replicas_) {
+    pending += replica.output.size() - replica.output_offset;
+  }
+  return pending;
+}
+
+void ReplicationPublisher::acceptReplicas() {
+  while (true) {
+    int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      return;
+    }
+
+    Replica& replica = replicas_[fd];
+    startSnapshot(replica);
+    if (!publishTo(fd, replica, manager_.getChangeSequence())) {
+      dropReplica(fd);
+    }
+  }
+}
+
+void ReplicationPublisher::startSnapshot(Replica& replica) {
+  replica.snapshot = manager_.snapshot();
+  replica.snapshot_next_id = 0;
+
+  replica.output += "SNAPSHOT ";
+  replica.output += std::to_string(replica.snapshot->getSequence());
+  replica.output += ' ';
+  replica.output += std::to_string(replica.snapshot->getTotalBooks());
+  replica.output += '\n';
+
+  replica.next_sequence = replica.snapshot->getSequence() + 1;
+  replica.head_sent = replica.snapshot->getSequence();
+}
+
+void ReplicationPublisher::fillOutput(Replica& replica, uint64_t head) {
+  auto pending = [&replica] { return replica.output.size() - replica.output_offset; };
+
+  while (pending() < kMaxPendingOutput) {
+    if (replica.snapshot) {
+      bool finished = replica.snapshot->forEachBookFrom(
+          replica.snapshot_next_id, [&](const BookView& book) {
+            appendBookRecord(book, replica.output);
+            replica.snapshot_next_id = book.getBookID() + 1;
+            return pending() < kMaxPendingOutput;
+          });
+      if (!finished) {
+        return;
+      }
+      replica.snapshot.reset();
+      continue;
+    }
+
+    if (replica.next_sequence > head) {
+      break;
+    }
+    ChangeBatch batch = feed_->pull(replica.next_sequence, kMaxBatch);
+    if (batch.overrun || batch.events.empty()) {
+      // The feed no longer holds what this replica needs
+      startSnapshot(replica);
+      continue;
+    }
+
+    for (const auto& event : batch.events) {
+      replica.output += "DELTA ";
+      replica.output += std::to_string(event.sequence);
+      replica.output += ' ';
+      replica.output += changeName(event.type);
+      replica.output += ' ';
+      if (event.book) {
+        appendBookRecord(*event.book, replica.output);
+      } else {
+        replica.output += std::to_string(event.book_id);
+        replica.output += '\n';
+      }
+    }
+    replica.next_sequence = batch.next_sequence;
+  }
+
+  // A HEAD line in the middle of a snapshot would be read as a book record
+  if (!replica.snapshot && replica.head_sent != head) {
+    replica.output += "HEAD ";
+    replica.output += std::to_string(head);
+    replica.output += '\n';
+    replica.head_sent = head;
+  }
+}
+
+bool ReplicationPublisher::publishTo(int fd, Replica& replica, uint64_t head) {
+  // Refill whenever the socket took everything, until nothing is left to send
+  do {
+    fillOutput(replica, head);
+    if (!flush(fd, replica)) {
+      return false;
+    }
+  } while (replica.output.empty() && (replica.snapshot || replica.next_sequence <= head));
+
+  return updateInterest(fd, replica);
+}
+
+bool ReplicationPublisher::updateInterest(int fd, Replica& replica) {
+  uint32_t events = EPOLLRDHUP;
+  if (!replica.output.empty()) {
+    events |= EPOLLOUT;
+  }
+  if (events == replica.events) {
+    return true;
+  }
+
+  epoll_event event{};
+  event.events = events;
+  event.data.fd = fd;
+  int operation = replica.events == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+  if (::epoll_ctl(epoll_fd_, operation, fd, &event) < 0) {
+    return false;
+  }
+  replica.events = events;
+  return true;
+}
+
+void ReplicationPublisher::dropReplica(int fd) {
+  ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  ::close(fd);
+  replicas_.erase(fd);
+}
+
+bool ReplicationPublisher::flush(int fd, Replica& replica) {
+  while (replica.output_offset < replica.output.size()) {
+    ssize_t sent = ::send(fd,
+                          replica.output.data() + replica.output_offset,
+                          replica.output.size() - replica.output_offset,
+                          MSG_NOSIGNAL);
+    if (sent > 0) {
+      replica.output_offset += static_cast<size_t>(sent);
+    } else if (sent < 0 && errno == EINTR) {
+      continue;
+    } else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    } else {
+      return false;
+    }
+  }
+
+  if (replica.output_offset == replica.output.size()) {
+    replica.output.clear();
+    replica.output_offset = 0;
+  } else if (replica.output_offset > replica.output.size() / 2) {
+    replica.output.erase(0, replica.output_offset);
+    replica.output_offset = 0;
+  }
+  return true;
+}
+
+// ReplicationClient
+
+ReplicationClient::ReplicationClient(LibraryManager& manager, std::string_view socket_path)
+    : manager_(manager), socket_path_(socket_path), last_contact_(Clock::now()) {
+  epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0) {
+    throwSystemError("epoll_create1");
+  }
+  try {
+    connect();
+  } catch (...) {
+    ::close(epoll_fd_);
+    throw;
+  }
+}
+
+ReplicationClient::~ReplicationClient() {
+  if (socket_fd_ >= 0) {
+    ::close(socket_fd_);
+  }
+  ::close(epoll_fd_);
+}
+
+int ReplicationClient::fd() const {
+  return epoll_fd_;
+}
+
+bool ReplicationClient::poll() {
+  std::array<char, kReadChunkSize> buffer;
+  bool connected = true;
+
+  for (size_t i = 0; i < kMaxReadsPerPoll; ++i) {
+    ssize_t received = ::read(socket_fd_, buffer.data(), buffer.size());
+    if (received > 0) {
+      input_.append(buffer.data(), static_cast<size_t>(received));
+    } else if (received < 0 && errno == EINTR) {
+      continue;
+    } else if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    } else {
+      connected = false;
+      break;
+    }
+  }
+
+  size_t start = 0;
+  size_t newline;
+  while (!gap_detected_ && (newline = input_.find('\n', start)) != std::string::npos) {
+    if (!handleLine(std::string_view(input_).substr(start, newline - start))) {
+      return false;
+    }
+    start = newline + 1;
+  }
+  input_.erase(0, start);
+
+  if (gap_detected_) {
+    return resync();
+  }
+  return connected;
+}
+
+bool ReplicationClient::isBootstrapped() const {
+  return bootstrapped_;
+}
+
+uint64_t ReplicationClient::appliedSequence() const {
+  return manager_.getChangeSequence();
+}
+
+uint64_t ReplicationClient::primarySequence() const {
+  return primary_sequence_;
+}
+
+uint64_t ReplicationClient::lag() const {
+  uint64_t applied = appliedSequence();
+  return primary_sequence_ > applied ? primary_sequence_ - applied : 0;
+}
+
+ReplicationClient::Clock::time_point ReplicationClient::lastContact() const {
+  return last_contact_;
+}
+
+size_t ReplicationClient::resyncCount() const {
+  return resync_count_;
+}
+
+void ReplicationClient::connect() {
+  sockaddr_un address = socketAddress(socket_path_);
+
+  int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    throwSystemError("socket");
+  }
+  epoll_event event{};
+  event.events = EPOLLIN | EPOLLRDHUP;
+  event.data.fd = fd;
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+      ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK) < 0 ||
+      ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+    int error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(), "connect");
+  }
+  socket_fd_ = fd;
+}
+
+bool ReplicationClient::resync() {
+  gap_detected_ = false;
+  ++resync_count_;
+
+  ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, socket_fd_, nullptr);
+  ::close(socket_fd_);
+  socket_fd_ = -1;
+  input_.clear();
+  snapshot_remaining_ = 0;
+  std::vector<Book>().swap(snapshot_books_);
+
+  try {
+    connect();
+  } catch (const std::system_error&) {
+    return false;
+  }
+  return true;
+}
+
+bool ReplicationClient::handleLine(std::string_view line) {
+  last_contact_ = Clock::now();
+
+  if (snapshot_remaining_ > 0) {
+    auto book = parseBookRecord(line);
+    if (!book) {
+      return false;
+    }
+    snapshot_books_.push_back(std::move(*book));
+    if (--snapshot_remaining_ == 0) {
+      manager_.loadCatalog(snapshot_books_, snapshot_sequence_);
+      std::vector<Book>().swap(snapshot_books_);
+      bootstrapped_ = true;
+    }
+    return true;
+  }
+
+  auto [command, args] = splitWord(line);
+
+  if (command == "SNAPSHOT") {
+    auto [sequence_text, count_text] = splitWord(args);
+    auto sequence = parseNumber<uint64_t>(sequence_text);
+    auto count = parseNumber<size_t>(count_text);
+    if (!sequence || !count) {
+      return false;
+    }
+
+    snapshot_sequence_ = *sequence;
+    snapshot_remaining_ = *count;
+    primary_sequence_ = std::max(primary_sequence_, *sequence);
+    snapshot_books_.clear();
+    snapshot_books_.reserve(*count);
+    if (*count == 0) {
+      manager_.loadCatalog({}, snapshot_sequence_);
+      bootstrapped_ = true;
+    }
+    return true;
+  }
+
+  if (command == "DELTA") {
+    return handleDelta(args);
+  }
+
+  if (command == "HEAD") {
+    auto sequence = parseNumber<uint64_t>(args);
+    if (!sequence) {
+      return false;
+    }
+    primary_sequence_ = std::max(primary_sequence_, *sequence);
+    return true;
+  }
+
+  return false;
+}
+
+bool ReplicationClient::handleDelta(std::string_view args) {
+  auto [sequence_text, rest] = splitWord(args);
+  auto [type_text, payload] = splitWord(rest);
+  auto sequence = parseNumber<uint64_t>(sequence_text);
+  auto type = parseChangeType(type_text);
+  if (!sequence || !type || !bootstrapped_) {
+    return false;
+  }
+
+  ChangeEvent event{*sequence, *type, 0, std::nullopt};
+  if (*type == ChangeType::Add || *type == ChangeType::Update) {
+    event.book = parseBookRecord(payload);
+    if (!event.book) {
+      return false;
+    }
+    event.book_id = event.book->getBookID();
+  } else {
+    auto book_id = parseNumber<unsigned int>(payload);
+    if (!book_id) {
+      return false;
+    }
+    event.book_id = *book_id;
+  }
+
+  primary_sequence_ = std::max(primary_sequence_, *sequence);
+  uint64_t applied = appliedSequence();
+  if (*sequence <= applied) {
+    return true;
+  }
+  if (*sequence != applied + 1) {
+    // A change went missing; applying later ones would diverge silently
+    gap_detected_ = true;
+    return true;
+  }
+  manager_.applyChange(event);
+  return true;
+}
@@ -0,0 +1,172 @@
+#include "../include/request_handler.h"
+
+#include <optional>
+
+namespace {
+
+std::string_view trim(std::string_view text) {
+  while (!text.empty() && (text.front() == ' ' || text.front() == '\r')) {
+    text.remove_prefix(1);
+  }
+  while (!text.empty() && (text.back() == ' ' || text.back() == '\r')) {
+    text.remove_suffix(1);
+  }
+  return text;
+}
+
+// Splits "WORD rest" into the first word and the remaining text
+std::pair<std::string_view, std::string_view> splitWord(std::string_view text) {
+  text = trim(text);
+  size_t space = text.find(' ');
+  if (space == std::string_view::npos) {
+    return {text, {}};
+  }
+  return {text.substr(0, space), trim(text.substr(space + 1))};
+}
+
+} // namespace
+
+RequestHandler::RequestHandler(LibraryManager& manager) : manager_(manager) {
+}
+
+void RequestHandler::handle(std::string_view request, std::string& out) {
+  auto [command, args] = splitWord(request);
+
+  bool is_write = command == "ADD" || command == "BORROW" || command == "RETURN";
+  if (is_write && read_only_) {
+    appendError("read-only replica", out);
+  } else if (command == "GET") {
+    handleGet(args, out);
+  } else if (command == "SEARCH") {
+    handleSearch(args, out);
+  } else if (command == "ADD") {
+    handleAdd(args, out);
+  } else if (command == "BORROW") {
+    handleBorrow(args, out);
+  } else if (command == "RETURN") {
+    handleReturn(args, out);
+  } else if (command == "STATS") {
+    handleStats(out);
+  } else if (command == "COMPACT") {
+    handleCompact(out);
+  } else {
+    appendError("unknown command", out);
+  }
+}
+
+void RequestHandler::setReadOnly(bool read_only) {
+  read_only_ = read_only;
+}
+
+void RequestHandler::setLagSource(std::function<uint64_t()> lag) {
+  lag_ = std::move(lag);
+}
+
+void RequestHandler::handleGet(std::string_view args, std::string& out) {
+  auto book_id = parseNumber(args);
+  if (!book_id) {
+    appendError("invalid book id", out);
+    return;
+  }
+
+  auto book = manager_.getBook(*book_id);
+  if (!book) {
+    appendError("book not found", out);
+    return;
+  }
+  appendBooks({*book}, out);
+}
+
+void RequestHandler::handleSearch(std::string_view args, std::string& out) {
+  auto [field, query] = splitWord(args);
+
+  if (field == "TITLE") {
+    appendBooks(manager_.searchByTitle(query), out);
+  } else if (field == "AUTHOR") {
+    appendBooks(manager_.searchByAuthor(query), out);
+  } else if (field == "CATEGORY") {
+    appendBooks(manager_.searchByCategory(query), out);
+  } else if (field == "RANKED") {
+    appendBooks(manager_.searchRanked(query), out);
+  } else {
+    appendError("unknown search field", out);
+  }
+}
+
+void RequestHandler::handleAdd(std::string_view args, std::string& out) {
+  auto book = parseAddFields(args);
+  if (!book) {
+    appendError(book.error(), out);
+    return;
+  }
+
+  unsigned int book_id = manager_.addBook(book->getTitle(),
+                                          book->getAuthor(),
+                                          book->getISBN(),
+                                          book->getPublicationYear(),
+                                          book->getCategory());
+  out += "OK ";
+  out += std::to_string(book_id);
+  out += '\n';
+}
+
+void RequestHandler::handleBorrow(std::string_view args, std::string& out) {
+  auto book_id = parseNumber(args);
+  if (!book_id || !manager_.borrowBook(*book_id)) {
+    appendError("book not available for borrowing", out);
+    return;
+  }
+  out += "OK\n";
+}
+
+void RequestHandler::handleReturn(std::string_view args, std::string& out) {
+  auto book_id = parseNumber(args);
+  if (!book_id || !manager_.returnBook(*book_id)) {
+    appendError("book was not borrowed or not found", out);
+    return;
+  }
+  out += "OK\n";
+}
+
+void RequestHandler::handleStats(std::string& out) {
+  // Reserved books and books under maintenance are neither available nor borrowed
+  auto by_status = manager_.getFacetCounts().by_status;
+
+  out += "OK total=";
+  out += std::to_string(manager_.getTotalBooks());
+  out += " available=";
+  out += std::to_string(by_status[BookStatus::Available]);
+  out += " borrowed=";
+  out += std::to_string(by_status[BookStatus::Borrowed]);
+  if (lag_) {
+    out += " lag=";
+    out += std::to_string(lag_());
+  }
+  out += '\n';
+}
+
+void RequestHandler::handleCompact(std::string& out) {
+  CompactionReport report = manager_.compact();
+
+  out += "OK bytes_before=";
+  out += std::to_string(report.before.total());
+  out += " bytes_after=";
+  out += std::to_string(report.after.total());
+  out += '\n';
+}
+
+void RequestHandler::appendBooks(const std::vector<Book>& books, std::string& out) {
+  out += "OK ";
+  out += std::to_string(books.size());
+  out += '\n';
+
+  for (const auto& book : books) {
+    appendBookRecord(book, out);
+  }
+}
+
+void RequestHandler::appendError(std::string_view message, std::string& out) {
+  out += "ERR ";
+  out += message;
+  out += '\n';
+}
@@ -0,0 +1,358 @@
+#include "../include/roaring_bitmap.h"
+#include "../include/memory_usage.h"
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+
+namespace {
+
+uint16_t highBits(uint32_t value) {
+  return static_cast<uint16_t>(value >> 16);
+}
+
+uint16_t lowBits(uint32_t value) {
+  return static_cast<uint16_t>(value & 0xFFFF);
+}
+
+} // namespace
+
+// Container
+
+bool RoaringBitmap::Container::contains(uint16_t low) const {
+  if (isBitmap()) {
+    return (bitmap[low / 64] >> (low % 64)) & 1U;
+  }
+  return std::binary_search(array.begin(), array.end(), low);
+}
+
+bool RoaringBitmap::Container::add(uint16_t low) {
+  if (isBitmap()) {
+    uint64_t& word = bitmap[low / 64];
+    uint64_t mask = uint64_t{1} << (low % 64);
+    if (word & mask) {
+      return false;
+    }
+    word |= mask;
+    ++cardinality;
+    return true;
+  }
+
+  auto it = std::lower_bound(array.begin(), array.end(), low);
+  if (it != array.end() && *it == low) {
+    return false;
+  }
+  array.insert(it, low);
+  ++cardinality;
+
+  // Convert to a bitmap once the array outgrows the dense representation
+  if (array.size() > kArrayMaxSize) {
+    bitmap.assign(kBitmapWords, 0);
+    for (uint16_t v : array) {
+      bitmap[v / 64] |= uint64_t{1} << (v % 64);
+    }
+    std::vector<uint16_t>().swap(array);
+  }
+  return true;
+}
+
+bool RoaringBitmap::Container::remove(uint16_t low) {
+  if (!isBitmap()) {
+    auto it = std::lower_bound(array.begin(), array.end(), low);
+    if (it == array.end() || *it != low) {
+      return false;
+    }
+    array.erase(it);
+    --cardinality;
+    return true;
+  }
+
+  uint64_t& word = bitmap[low / 64];
+  uint64_t mask = uint64_t{1} << (low % 64);
+  if (!(word & mask)) {
+    return false;
+  }
+  word &= ~mask;
+  --cardinality;
+
+  // Convert back to an array once the container is sparse again
+  if (cardinality <= kArrayMaxSize) {
+    array.reserve(cardinality);
+    for (size_t i = 0; i < kBitmapWords; ++i) {
+      for (uint64_t w = bitmap[i]; w != 0; w &= w - 1) {
+        array.push_back(static_cast<uint16_t>(i * 64 + std::countr_zero(w)));
+      }
+    }
+    std::vector<uint64_t>().swap(bitmap);
+  }
+  return true;
+}
+
+// RoaringBitmap
+
+void RoaringBitmap::add(uint32_t value) {
+  uint16_t key = highBits(value);
+  auto it = std::lower_bound(containers_.begin(),
+                             containers_.end(),
+                             key,
+                             [](const Container& c, uint16_t k) { return c.key < k; });
+  if (it == containers_.end() || it->key != key) {
+    it = containers_.insert(it, Container{});
+    it->key = key;
+  }
+  it->add(lowBits(value));
+}
+
+bool RoaringBitmap::remove(uint32_t value) {
+  uint16_t key = highBits(value);
+  auto it = std::lower_bound(containers_.begin(),
+                             containers_.end(),
+                             key,
+                             [](const Container& c, uint16_t k) { return c.key < k; });
+  if (it == containers_.end() || it->key != key || !it->remove(lowBits(value))) {
+    return false;
+  }
+  if (it->cardinality == 0) {
+    containers_.erase(it);
+  }
+  return true;
+}
+
+void RoaringBitmap::clear() {
+  containers_.clear();
+}
+
+bool RoaringBitmap::contains(uint32_t value) const {
+  const Container* container = findContainer(highBits(value));
+  return container != nullptr && container->contains(lowBits(value));
+}
+
+size_t RoaringBitmap::cardinality() const {
+  size_t total = 0;
+  for (const auto& container : containers_) {
+    total += container.cardinality;
+  }
+  return total;
+}
+
+bool RoaringBitmap::empty() const {
+  return containers_.empty();
+}
+
+std::optional<uint32_t> RoaringBitmap::minimum() const {
+  if (containers_.empty()) {
+    return std::nullopt;
+  }
+
+  const Container& first = containers_.front();
+  uint32_t base = static_cast<uint32_t>(first.key) << 16;
+  if (!first.isBitmap()) {
+    return base | first.array.front();
+  }
+  for (size_t i = 0; i < kBitmapWords; ++i) {
+    if (first.bitmap[i] != 0) {
+      return base | static_cast<uint32_t>(i * 64 + std::countr_zero(first.bitmap[i]));
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<uint32_t> RoaringBitmap::maximum() const {
+  if (containers_.empty()) {
+    return std::nullopt;
+  }
+
+  const Container& last = containers_.back();
+  uint32_t base = static_cast<uint32_t>(last.key) << 16;
+  if (!last.isBitmap()) {
+    return base | last.array.back();
+  }
+  for (size_t i = kBitmapWords; i-- > 0;) {
+    if (last.bitmap[i] != 0) {
+      return base | static_cast<uint32_t>(i * 64 + 63 - std::countl_zero(last.bitmap[i]));
+    }
+  }
+  return std::nullopt;
+}
+
+RoaringBitmap RoaringBitmap::intersect(const RoaringBitmap& other) const {
+  RoaringBitmap result;
+  auto lhs = containers_.begin();
+  auto rhs = other.containers_.begin();
+
+  while (lhs != containers_.end() && rhs != other.containers_.end()) {
+    if (lhs->key < rhs->key) {
+      ++lhs;
+    } else if (rhs->key < lhs->key) {
+      ++rhs;
+    } else {
+      Container container = intersect(*lhs, *rhs);
+      if (container.cardinality > 0) {
+        result.containers_.push_back(std::move(container));
+      }
+      ++lhs;
+      ++rhs;
+    }
+  }
+
+  return result;
+}
+
+size_t RoaringBitmap::intersectionCardinality(const RoaringBitmap& other) const {
+  size_t total = 0;
+  auto lhs = containers_.begin();
+  auto rhs = other.containers_.begin();
+
+  while (lhs != containers_.end() && rhs != other.containers_.end()) {
+    if (lhs->key < rhs->key) {
+      ++lhs;
+    } else if (rhs->key < lhs->key) {
+      ++rhs;
+    } else {
+      total += intersectionCardinality(*lhs, *rhs);
+      ++lhs;
+      ++rhs;
+    }
+  }
+
+  return total;
+}
+
+std::vector<uint32_t> RoaringBitmap::toVector() const {
+  std::vector<uint32_t> result;
+  result.reserve(cardinality());
+
+  for (const auto& container : containers_) {
+    uint32_t base = static_cast<uint32_t>(container.key) << 16;
+    if (container.isBitmap()) {
+      for (size_t i = 0; i < kBitmapWords; ++i) {
+        for (uint64_t w = container.bitmap[i]; w != 0; w &= w - 1) {
+          result.push_back(base | static_cast<uint32_t>(i * 64 + std::countr_zero(w)));
+        }
+      }
+    } else {
+      for (uint16_t low : container.array) {
+        result.push_back(base | low);
+      }
+    }
+  }
+
+  return result;
+}
+
+void RoaringBitmap::shrinkToFit() {
+  for (auto& container : containers_) {
+    container.array.shrink_to_fit();
+  }
+  containers_.shrink_to_fit();
+}
+
+size_t RoaringBitmap::memoryUsage() const {
+  size_t bytes = heapBytes(containers_);
+  for (const auto& container : containers_) {
+    bytes += heapBytes(container.array) + heapBytes(container.bitmap);
+  }
+  return bytes;
+}
+
+bool operator==(const RoaringBitmap& lhs, const RoaringBitmap& rhs) {
+  return std::equal(lhs.containers_.begin(),
+                    lhs.containers_.end(),
+                    rhs.containers_.begin(),
+                    rhs.containers_.end(),
+                    [](const RoaringBitmap::Container& a, const RoaringBitmap::Container& b) {
+                      return a.key == b.key && a.cardinality == b.cardinality &&
+                             a.array == b.array && a.bitmap == b.bitmap;
+                    });
+}
+
+const RoaringBitmap::Container* RoaringBitmap::findContainer(uint16_t key) const {
+  auto it = std::lower_bound(containers_.begin(),
+                             containers_.end(),
+                             key,
+                             [](const Container& c, uint16_t k) { return c.key < k; });
+  if (it == containers_.end() || it->key != key) {
+    return nullptr;
+  }
+  return &*it;
+}
+
+size_t RoaringBitmap::intersectionCardinality(const Container& lhs, const Container& rhs) {
+  if (lhs.isBitmap() && rhs.isBitmap()) {
+    size_t count = 0;
+    for (size_t i = 0; i < kBitmapWords; ++i) {
+      count += std::popcount(lhs.bitmap[i] & rhs.bitmap[i]);
+    }
+    return count;
+  }
+
+  if (lhs.isBitmap() || rhs.isBitmap()) {
+    const Container& sparse = lhs.isBitmap() ? rhs : lhs;
+    const Container& dense = lhs.isBitmap() ? lhs : rhs;
+    return std::count_if(sparse.array.begin(), sparse.array.end(), [&dense](uint16_t v) {
+      return dense.contains(v);
+    });
+  }
+
+  // Merge two sorted arrays
+  size_t count = 0;
+  auto a = lhs.array.begin();
+  auto b = rhs.array.begin();
+  while (a != lhs.array.end() && b != rhs.array.end()) {
+    if (*a < *b) {
+      ++a;
+    } else if (*b < *a) {
+      ++b;
+    } else {
+      ++count;
+      ++a;
+      ++b;
+    }
+  }
+  return count;
+}
+
+RoaringBitmap::Container RoaringBitmap::intersect(const Container& lhs, const Container& rhs) {
+  Container result;
+  result.key = lhs.key;
+
+  if (lhs.isBitmap() && rhs.isBitmap()) {
+    std::vector<uint64_t> words(kBitmapWords);
+    size_t count = 0;
+    for (size_t i = 0; i < kBitmapWords; ++i) {
+      words[i] = lhs.bitmap[i] & rhs.bitmap[i];
+      count += std::popcount(words[i]);
+    }
+
+    if (count > kArrayMaxSize) {
+      result.bitmap = std::move(words);
+    } else {
+      result.array.reserve(count);
+      for (size_t i = 0; i < kBitmapWords; ++i) {
+        for (uint64_t w = words[i]; w != 0; w &= w - 1) {
+          result.array.push_back(static_cast<uint16_t>(i * 64 + std::countr_zero(w)));
+        }
+      }
+    }
+    result.cardinality = static_cast<uint32_t>(count);
+    return result;
+  }
+
+  if (lhs.isBitmap() || rhs.isBitmap()) {
+    const Container& sparse = lhs.isBitmap() ? rhs : lhs;
+    const Container& dense = lhs.isBitmap() ? lhs : rhs;
+    std::copy_if(sparse.array.begin(),
+                 sparse.array.end(),
+                 std::back_inserter(result.array),
+                 [&dense](uint16_t v) { return dense.contains(v); });
+  } else {
+    std::set_intersection(lhs.array.begin(),
+                          lhs.array.end(),
+                          rhs.array.begin(),
+                          rhs.array.end(),
+                          std::back_inserter(result.array));
+  }
+
+  result.cardinality = static_cast<uint32_t>(result.array.size());
+  return result;
+}
@@ -0,0 +1,203 @@
+#include "../include/search_index.h"
+#include "../include/memory_usage.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace {
+
+// Every byte of a multi-byte UTF-8 character counts, so words in any script
+// are tokens; only ASCII letters are case-folded
+bool isTokenChar(unsigned char c) {
+  return c >= 0x80 || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+         (c >= 'A' && c <= 'Z') || c == '+' || c == '#';
+}
+
+char lowerAscii(unsigned char c) {
+  return static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+}
+
+// Ranking order: higher score first, then lower book ID
+bool betterHit(const SearchHit& lhs, const SearchHit& rhs) {
+  if (lhs.score != rhs.score) {
+    return lhs.score > rhs.score;
+  }
+  return lhs.book_id < rhs.book_id;
+}
+
+} // namespace
+
+bool SearchIndex::postingBefore(const Posting& posting, unsigned int book_id) {
+  return posting.book_id < book_id;
+}
+
+void SearchIndex::addDocument(unsigned int book_id,
+                              std::string_view title,
+                              std::string_view author) {
+  FieldLengths lengths{};
+
+  for (auto& [term, posting] : termFrequencies(book_id, title, author)) {
+    for (size_t field = 0; field < kFieldCount; ++field) {
+      lengths[field] += posting.term_frequency[field];
+    }
+
+    auto& list = postings_[term];
+    auto it = std::lower_bound(list.begin(), list.end(), book_id, postingBefore);
+    list.insert(it, posting);
+  }
+
+  for (size_t field = 0; field < kFieldCount; ++field) {
+    total_field_length_[field] += lengths[field];
+  }
+  field_lengths_[book_id] = lengths;
+}
+
+void SearchIndex::removeDocument(unsigned int book_id,
+                                 std::string_view title,
+                                 std::string_view author) {
+  auto doc = field_lengths_.find(book_id);
+  if (doc == field_lengths_.end()) {
+    return;
+  }
+
+  for (const auto& [term, posting] : termFrequencies(book_id, title, author)) {
+    auto list = postings_.find(term);
+    if (list == postings_.end()) {
+      continue;
+    }
+
+    auto& entries = list->second;
+    auto it = std::lower_bound(entries.begin(), entries.end(), book_id, postingBefore);
+    if (it != entries.end() && it->book_id == book_id) {
+      entries.erase(it);
+    }
+    if (entries.empty()) {
+      postings_.erase(list);
+    }
+  }
+
+  for (size_t field = 0; field < kFieldCount; ++field) {
+    total_field_length_[field] -= doc->second[field];
+  }
+  field_lengths_.erase(doc);
+}
+
+std::vector<SearchHit> SearchIndex::search(std::string_view query, size_t k) const {
+  if (k == 0 || field_lengths_.empty()) {
+    return {};
+  }
+
+  auto terms = tokenize(query);
+  std::sort(terms.begin(), terms.end());
+  terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+  const double doc_count = static_cast<double>(field_lengths_.size());
+  std::array<double, kFieldCount> average_length{};
+  for (size_t field = 0; field < kFieldCount; ++field) {
+    average_length[field] =
+        std::max(1.0, static_cast<double>(total_field_length_[field]) / doc_count);
+  }
+
+  // Accumulate BM25 scores per matching document
+  std::unordered_map<unsigned int, double> scores;
+  for (const auto& term : terms) {
+    auto list = postings_.find(term);
+    if (list == postings_.end()) {
+      continue;
+    }
+
+    const double df = static_cast<double>(list->second.size());
+    const double idf = std::log(1.0 + (doc_count - df + 0.5) / (df + 0.5));
+
+    for (const auto& posting : list->second) {
+      const FieldLengths& lengths = field_lengths_.at(posting.book_id);
+      double weight = 0.0;
+      for (size_t field = 0; field < kFieldCount; ++field) {
+        const double tf = posting.term_frequency[field];
+        if (tf == 0.0) {
+          continue;
+        }
+        const double norm = kK1 * (1.0 - kB + kB * lengths[field] / average_length[field]);
+        weight += kFieldBoosts[field] * tf * (kK1 + 1.0) / (tf + norm);
+      }
+      scores[posting.book_id] += idf * weight;
+    }
+  }
+
+  // Keep only the best k in a bounded heap whose top is the worst hit kept so far
+  std::priority_queue<SearchHit, std::vector<SearchHit>, decltype(&betterHit)> heap(&betterHit);
+  for (const auto& [book_id, score] : scores) {
+    SearchHit hit{book_id, score};
+    if (heap.size() < k) {
+      heap.push(hit);
+    } else if (betterHit(hit, heap.top())) {
+      heap.pop();
+      heap.push(hit);
+    }
+  }
+
+  std::vector<SearchHit> result(heap.size());
+  for (auto it = result.rbegin(); it != result.rend(); ++it) {
+    *it = heap.top();
+    heap.pop();
+  }
+  return result;
+}
+
+size_t SearchIndex::documentCount() const {
+  return field_lengths_.size();
+}
+
+void SearchIndex::compact() {
+  for (auto& [term, list] : postings_) {
+    list.shrink_to_fit();
+  }
+  postings_.rehash(0);
+  field_lengths_.rehash(0);
+}
+
+size_t SearchIndex::memoryUsage() const {
+  size_t bytes = heapBytes(postings_) + heapBytes(field_lengths_);
+  for (const auto& [term, list] : postings_) {
+    bytes += heapBytes(term) + heapBytes(list);
+  }
+  return bytes;
+}
+
+std::vector<std::string> SearchIndex::tokenize(std::string_view text) {
+  std::vector<std::string> tokens;
+  std::string current;
+
+  for (char ch : text) {
+    auto c = static_cast<unsigned char>(ch);
+    if (isTokenChar(c)) {
+      current.push_back(lowerAscii(c));
+    } else if (!current.empty()) {
+      tokens.push_back(std::move(current));
+      current.clear();
+    }
+  }
+  if (!current.empty()) {
+    tokens.push_back(std::move(current));
+  }
+
+  return tokens;
+}
+
+std::unordered_map<std::string, SearchIndex::Posting> SearchIndex::termFrequencies(
+    unsigned int book_id, std::string_view title, std::string_view author) {
+  std::unordered_map<std::string, Posting> frequencies;
+
+  auto count = [&](std::string_view text, Field field) {
+    for (auto& token : tokenize(text)) {
+      Posting& posting = frequencies[std::move(token)];
+      posting.book_id = book_id;
+      ++posting.term_frequency[field];
+    }
+  };
+  count(title, Title);
+  count(author, Author);
+
+  return frequencies;
+}
@@ -0,0 +1,95 @@
+#include "../include/string_heap.h"
+#include "../include/copy_on_write.h"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint64_t kMaxHeapSize = uint64_t{std::numeric_limits<uint32_t>::max()} + 1;
+
+} // namespace
+
+StringRef StringHeap::append(std::string_view text) {
+  if (text.empty()) {
+    return {};
+  }
+
+  uint64_t used_in_window = size_ & (kWindowSize - 1);
+  bool fits = size_ > 0 && used_in_window > 0 && used_in_window + text.size() <= kWindowSize;
+  // The tail block may span several windows; only its last one is appended to
+  if (fits && pages_->blocks.back().first_window + pages_->blocks.back().window_count !=
+                  (size_ >> kWindowBits) + 1) {
+    fits = false;
+  }
+
+  if (!fits) {
+    // Start a new block on the next window boundary
+    uint64_t start = (size_ + kWindowSize - 1) & ~uint64_t{kWindowSize - 1};
+    uint64_t windows = (text.size() + kWindowSize - 1) / kWindowSize;
+    if (start + windows * kWindowSize > kMaxHeapSize) {
+      throw std::length_error("string heap exceeds 4 GiB");
+    }
+
+    Pages& pages = mutablePages();
+    Block block;
+    block.data = std::shared_ptr<char[]>(new char[windows * kWindowSize]);
+    block.first_window = static_cast<uint32_t>(start >> kWindowBits);
+    block.window_count = static_cast<uint32_t>(windows);
+    for (uint64_t i = 0; i < windows; ++i) {
+      pages.windows.push_back(block.data.get() + i * kWindowSize);
+    }
+    pages.blocks.push_back(std::move(block));
+    size_ = start;
+  }
+
+  char* tail = writableTail(mutablePages());
+  uint64_t offset_in_block = size_ - (uint64_t{pages_->blocks.back().first_window} << kWindowBits);
+  std::memcpy(tail + offset_in_block, text.data(), text.size());
+
+  StringRef ref{static_cast<uint32_t>(size_), static_cast<uint32_t>(text.size())};
+  size_ += text.size();
+  return ref;
+}
+
+uint64_t StringHeap::size() const {
+  return size_;
+}
+
+size_t StringHeap::memoryUsage() const {
+  if (!pages_) {
+    return 0;
+  }
+
+  size_t bytes = sizeof(Pages) + pages_->blocks.capacity() * sizeof(Block) +
+                 pages_->windows.capacity() * sizeof(const char*);
+  for (const auto& block : pages_->blocks) {
+    bytes += size_t{block.window_count} * kWindowSize;
+  }
+  return bytes;
+}
+
+StringHeap::Pages& StringHeap::mutablePages() {
+  if (!pages_) {
+    pages_ = std::make_shared<Pages>();
+  } else if (!uniquelyOwned(pages_)) {
+    pages_ = std::make_shared<Pages>(*pages_);
+  }
+  return *pages_;
+}
+
+char* StringHeap::writableTail(Pages& pages) {
+  Block& tail = pages.blocks.back();
+  if (!uniquelyOwned(tail.data)) {
+    // Another copy may still read this block; give this heap its own bytes
+    uint64_t used = size_ - (uint64_t{tail.first_window} << kWindowBits);
+    auto clone = std::shared_ptr<char[]>(new char[size_t{tail.window_count} * kWindowSize]);
+    std::memcpy(clone.get(), tail.data.get(), used);
+    tail.data = std::move(clone);
+    for (uint32_t i = 0; i < tail.window_count; ++i) {
+      pages.windows[tail.first_window + i] = tail.data.get() + size_t{i} * kWindowSize;
+    }
+  }
+  return tail.data.get();
+}
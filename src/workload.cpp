@@ -0,0 +1,452 @@
+#include "../include/workload.h"
+
+#include "../include/book_record.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::array<std::string_view, kOperationTypeCount> kOperationNames = {
+    "get",
+    "search_title",
+    "search_author",
+    "search_category",
+    "search_ranked",
+    "add",
+    "borrow",
+    "return",
+};
+
+constexpr std::array<std::string_view, kOperationTypeCount> kRequestNames = {
+    "GET",
+    "SEARCH TITLE",
+    "SEARCH AUTHOR",
+    "SEARCH CATEGORY",
+    "SEARCH RANKED",
+    "ADD",
+    "BORROW",
+    "RETURN",
+};
+
+// Vocabularies are ordered roughly by how common they should be; the Zipf
+// samplers pick early entries most often
+constexpr std::string_view kTitleWords[] = {
+    "Night", "House", "Secret", "World", "Love", "Dark", "Last", "Time", "Garden", "Shadow", "City",
+    "River", "History", "Stars", "Storm", "Life", "Winter", "Queen", "Fire", "Sea", "Girl", "Light",
+    "War", "Island", "Road", "Summer", "King", "Silent", "Lost", "Song", "Empire", "Mountain",
+    "Blood", "Dream", "Forest", "Glass", "Iron", "Golden", "Memory", "Bridge", "Letters", "Journey",
+    "Machine", "Wild", "Stone", "Ocean", "Daughter", "Promise", "Hidden", "Broken", "Silver",
+    "North", "Winds", "Edge", "Heart", "Water", "Mirror", "Station", "Crown", "Ghost", "Moon",
+    "Ashes", "Orchard", "Harbor", "Lantern", "Atlas", "Compass", "Kingdom", "Rebel", "Signal",
+    "Theory", "Practice", "Guide", "Systems", "Design", "Patterns", "Algorithms", "Networks",
+    "Data", "Economics", "Physics", "Biology", "Chemistry", "Music", "Painting", "Cooking",
+    "Gardening", "Sailing", "Chess", "Philosophy", "Language"};
+
+constexpr std::string_view kFirstNames[] = {
+    "James", "Mary", "John", "Patricia", "Robert", "Jennifer", "Michael", "Linda", "David",
+    "Elizabeth", "William", "Barbara", "Richard", "Susan", "Joseph", "Jessica", "Thomas", "Sarah",
+    "Charles", "Karen", "Daniel", "Nancy", "Matthew", "Lisa", "Anthony", "Margaret", "Mark",
+    "Sandra", "Paul", "Ashley", "Steven", "Emily", "Andrew", "Donna", "Joshua", "Michelle",
+    "Kenneth", "Carol", "Kevin", "Amanda", "Brian", "Melissa", "George", "Deborah", "Haruki",
+    "Chimamanda", "Olga", "Gabriel"};
+
+constexpr std::string_view kLastNames[] = {
+    "Smith", "Johnson", "Williams", "Brown", "Jones", "Garcia", "Miller", "Davis", "Rodriguez",
+    "Martinez", "Hernandez", "Lopez", "Gonzalez", "Wilson", "Anderson", "Thomas", "Taylor", "Moore",
+    "Jackson", "Martin", "Lee", "Perez", "Thompson", "White", "Harris", "Sanchez", "Clark",
+    "Ramirez", "Lewis", "Robinson", "Walker", "Young", "Allen", "King", "Wright", "Scott", "Torres",
+    "Nguyen", "Hill", "Flores", "Green", "Adams", "Nelson", "Baker", "Hall", "Rivera", "Campbell",
+    "Mitchell"};
+
+constexpr std::string_view kCategories[] = {
+    "Fiction", "Mystery", "Romance", "Science Fiction", "Fantasy", "Biography", "History",
+    "Children", "Young Adult", "Thriller", "Self-Help", "Science", "Programming", "Business",
+    "Poetry", "Travel", "Cooking", "Art", "Philosophy", "Religion", "Health", "Sports", "Reference",
+    "Law"};
+
+constexpr unsigned int kLatestYear = 2025;
+constexpr unsigned int kYearSpan = 175;
+
+// Integer arithmetic on raw engine output instead of the standard
+// distributions, whose results differ between standard libraries, keeps a
+// seed's catalog the same everywhere
+uint64_t below(std::mt19937_64& random, uint64_t bound) {
+  return random() % bound;
+}
+
+double unitInterval(std::mt19937_64& random) {
+  return static_cast<double>(random() >> 11) * 0x1.0p-53;
+}
+
+// "978-" followed by ten digits, the last one a valid ISBN-13 check digit
+std::string makeISBN(std::mt19937_64& random) {
+  std::string isbn = "978-";
+  unsigned int sum = 9 + 3 * 7 + 8;
+  for (unsigned int i = 0; i < 9; ++i) {
+    auto digit = static_cast<unsigned int>(below(random, 10));
+    sum += i % 2 == 0 ? 3 * digit : digit;
+    isbn += static_cast<char>('0' + digit);
+  }
+  isbn += static_cast<char>('0' + (10 - sum % 10) % 10);
+  return isbn;
+}
+
+std::string lowercase(std::string_view text) {
+  std::string result(text);
+  std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) {
+    return static_cast<char>(std::tolower(c));
+  });
+  return result;
+}
+
+bool usesBookID(OperationType type) {
+  return type == OperationType::Get || type == OperationType::Borrow ||
+         type == OperationType::Return;
+}
+
+// Returns false when the catalog rejects the operation
+bool run(LibraryManager& manager, const Operation& operation, const std::optional<Book>& book) {
+  switch (operation.type) {
+  case OperationType::Get:
+    return manager.getBook(operation.book_id).has_value();
+  case OperationType::SearchTitle:
+    return !manager.searchByTitle(operation.text).empty();
+  case OperationType::SearchAuthor:
+    return !manager.searchByAuthor(operation.text).empty();
+  case OperationType::SearchCategory:
+    return !manager.searchByCategory(operation.text).empty();
+  case OperationType::SearchRanked:
+    return !manager.searchRanked(operation.text).empty();
+  case OperationType::Add:
+    if (!book) {
+      return false;
+    }
+    (void)manager.addBook(book->getTitle(),
+                          book->getAuthor(),
+                          book->getISBN(),
+                          book->getPublicationYear(),
+                          book->getCategory());
+    return true;
+  case OperationType::Borrow:
+    return manager.borrowBook(operation.book_id);
+  case OperationType::Return:
+    return manager.returnBook(operation.book_id);
+  }
+  return false;
+}
+
+} // namespace
+
+// Operations and traces
+
+void appendOperation(const Operation& operation, std::string& out) {
+  out += kRequestNames[static_cast<size_t>(operation.type)];
+  out += ' ';
+  if (usesBookID(operation.type)) {
+    out += std::to_string(operation.book_id);
+  } else {
+    out += operation.text;
+  }
+  out += '\n';
+}
+
+std::optional<Operation> parseOperation(std::string_view line) {
+  if (line.ends_with('\r')) {
+    line.remove_suffix(1);
+  }
+
+  for (size_t index = 0; index < kOperationTypeCount; ++index) {
+    std::string_view name = kRequestNames[index];
+    if (line.size() <= name.size() || !line.starts_with(name) || line[name.size()] != ' ') {
+      continue;
+    }
+
+    Operation operation;
+    operation.type = static_cast<OperationType>(index);
+    std::string_view args = line.substr(name.size() + 1);
+    if (usesBookID(operation.type)) {
+      auto book_id = parseNumber(args);
+      if (!book_id) {
+        return std::nullopt;
+      }
+      operation.book_id = *book_id;
+    } else {
+      operation.text = args;
+    }
+    return operation;
+  }
+  return std::nullopt;
+}
+
+std::string_view operationName(OperationType type) {
+  return kOperationNames[static_cast<size_t>(type)];
+}
+
+std::optional<OperationType> parseOperationName(std::string_view name) {
+  auto it = std::find(kOperationNames.begin(), kOperationNames.end(), name);
+  if (it == kOperationNames.end()) {
+    return std::nullopt;
+  }
+  return static_cast<OperationType>(it - kOperationNames.begin());
+}
+
+// ZipfDistribution
+
+ZipfDistribution::ZipfDistribution(size_t n, double exponent) : exponent_(exponent) {
+  if (n == 0) {
+    throw std::invalid_argument("Zipf distribution needs at least one rank");
+  }
+
+  cumulative_.reserve(n);
+  for (size_t rank = 0; rank < n; ++rank) {
+    addRank();
+  }
+}
+
+size_t ZipfDistribution::operator()(std::mt19937_64& random) const {
+  double target = unitInterval(random) * cumulative_.back();
+  auto it = std::upper_bound(cumulative_.begin(), cumulative_.end(), target);
+  return std::min(static_cast<size_t>(it - cumulative_.begin()), cumulative_.size() - 1);
+}
+
+void ZipfDistribution::addRank() {
+  double weight = 1.0 / std::pow(static_cast<double>(cumulative_.size() + 1), exponent_);
+  cumulative_.push_back(cumulative_.empty() ? weight : cumulative_.back() + weight);
+}
+
+size_t ZipfDistribution::size() const {
+  return cumulative_.size();
+}
+
+// WorkloadGenerator
+
+WorkloadGenerator::WorkloadGenerator(WorkloadOptions options)
+    : options_(options),
+      catalog_random_(options.seed),
+      operation_random_(options.seed ^ 0x9E3779B97F4A7C15),
+      words_(std::size(kTitleWords), 1.0),
+      authors_(std::max<size_t>(options.books / 8, 16), 1.0),
+      categories_(std::size(kCategories), 1.0),
+      popularity_(options.books, options.popularity_skew),
+      books_by_popularity_(options.books),
+      book_count_(static_cast<unsigned int>(options.books)),
+      on_loan_(options.books + 1) {
+  std::partial_sum(options.mix.begin(), options.mix.end(), mix_bounds_.begin());
+  if (mix_bounds_.back() == 0) {
+    throw std::invalid_argument("operation mix has no weight");
+  }
+
+  // The most popular books are spread over the whole ID range
+  std::iota(books_by_popularity_.begin(), books_by_popularity_.end(), 1u);
+  for (size_t i = books_by_popularity_.size(); i > 1; --i) {
+    std::swap(books_by_popularity_[i - 1], books_by_popularity_[below(operation_random_, i)]);
+  }
+}
+
+Book WorkloadGenerator::nextBook() {
+  return makeBook(catalog_random_);
+}
+
+void WorkloadGenerator::populate(LibraryManager& manager) {
+  for (size_t i = 0; i < options_.books; ++i) {
+    Book book = nextBook();
+    (void)manager.addBook(book.getTitle(),
+                          book.getAuthor(),
+                          book.getISBN(),
+                          book.getPublicationYear(),
+                          book.getCategory());
+  }
+}
+
+Operation WorkloadGenerator::nextOperation() {
+  Operation operation;
+  uint64_t pick = below(operation_random_, mix_bounds_.back());
+  operation.type = static_cast<OperationType>(
+      std::upper_bound(mix_bounds_.begin(), mix_bounds_.end(), pick) - mix_bounds_.begin());
+
+  switch (operation.type) {
+  case OperationType::Get:
+    operation.book_id = popularBook();
+    break;
+  case OperationType::SearchTitle:
+    operation.text = kTitleWords[words_(operation_random_)];
+    break;
+  case OperationType::SearchAuthor:
+    operation.text = authorName(authors_(operation_random_));
+    break;
+  case OperationType::SearchCategory:
+    operation.text = kCategories[categories_(operation_random_)];
+    break;
+  case OperationType::SearchRanked:
+    operation.text = lowercase(kTitleWords[words_(operation_random_)]);
+    operation.text += ' ';
+    operation.text += lowercase(kTitleWords[words_(operation_random_)]);
+    break;
+  case OperationType::Add: {
+    Book book = makeBook(operation_random_);
+    appendEscaped(book.getTitle(), operation.text);
+    operation.text += '\t';
+    appendEscaped(book.getAuthor(), operation.text);
+    operation.text += '\t';
+    appendEscaped(book.getISBN(), operation.text);
+    operation.text += '\t';
+    if (auto year = book.getPublicationYear()) {
+      operation.text += std::to_string(*year);
+    }
+    operation.text += '\t';
+    appendEscaped(book.getCategory(), operation.text);
+    addedBook();
+    break;
+  }
+  case OperationType::Borrow:
+    operation.book_id = popularBook();
+    if (!on_loan_[operation.book_id]) {
+      on_loan_[operation.book_id] = true;
+      borrowed_.push_back(operation.book_id);
+    }
+    break;
+  case OperationType::Return:
+    if (borrowed_.empty()) {
+      // Rejected by the catalog, as a return at an empty desk would be
+      operation.book_id = popularBook();
+      break;
+    }
+    size_t index = below(operation_random_, borrowed_.size());
+    operation.book_id = borrowed_[index];
+    borrowed_[index] = borrowed_.back();
+    borrowed_.pop_back();
+    on_loan_[operation.book_id] = false;
+    break;
+  }
+  return operation;
+}
+
+Book WorkloadGenerator::makeBook(std::mt19937_64& random) const {
+  std::string title;
+  if (below(random, 4) == 0) {
+    title = "The ";
+  }
+  size_t words = 1 + below(random, 3);
+  for (size_t i = 0; i < words; ++i) {
+    if (i > 0) {
+      title += ' ';
+    }
+    title += kTitleWords[words_(random)];
+  }
+  if (below(random, 5) == 0) {
+    title += " of ";
+    title += kTitleWords[words_(random)];
+  }
+
+  std::string author = authorName(authors_(random));
+  std::string isbn = makeISBN(random);
+
+  // Most books are recent; one in twenty has no known year
+  std::optional<unsigned int> year;
+  if (below(random, 20) != 0) {
+    double age = unitInterval(random);
+    year = kLatestYear - static_cast<unsigned int>(kYearSpan * age * age * age);
+  }
+
+  std::string_view category = kCategories[categories_(random)];
+  return Book(0, title, author, isbn, year, category);
+}
+
+unsigned int WorkloadGenerator::popularBook() {
+  return books_by_popularity_[popularity_(operation_random_)];
+}
+
+void WorkloadGenerator::addedBook() {
+  unsigned int book_id = ++book_count_;
+  on_loan_.push_back(false);
+
+  // The new book takes a random rank and the book it displaces becomes the
+  // least popular, so later operations can pick either of them
+  popularity_.addRank();
+  books_by_popularity_.push_back(book_id);
+  std::swap(books_by_popularity_.back(),
+            books_by_popularity_[below(operation_random_, books_by_popularity_.size())]);
+}
+
+std::string WorkloadGenerator::authorName(size_t index) {
+  constexpr size_t kFirstCount = std::size(kFirstNames);
+  constexpr size_t kLastCount = std::size(kLastNames);
+
+  std::string name(kFirstNames[index % kFirstCount]);
+  // Past every first/last pairing, tell authors apart by middle initials
+  // counted like spreadsheet columns (A..Z, then A. A. to Z. Z., ...), so
+  // every index gets a distinct name
+  std::string initials;
+  for (size_t generation = index / (kFirstCount * kLastCount); generation > 0;
+       generation = (generation - 1) / 26) {
+    initials.insert(0, {' ', static_cast<char>('A' + (generation - 1) % 26), '.'});
+  }
+  name += initials;
+  name += ' ';
+  name += kLastNames[(index / kFirstCount) % kLastCount];
+  return name;
+}
+
+// Replay
+
+uint64_t OperationStats::percentile(double p) const {
+  if (nanos.empty()) {
+    return 0;
+  }
+  return nanos[static_cast<size_t>(p * static_cast<double>(nanos.size() - 1))];
+}
+
+size_t ReplayReport::count() const {
+  size_t total = 0;
+  for (const auto& stats : operations) {
+    total += stats.count;
+  }
+  return total;
+}
+
+double ReplayReport::operationsPerSecond() const {
+  return seconds > 0.0 ? static_cast<double>(count()) / seconds : 0.0;
+}
+
+ReplayReport replayOperations(LibraryManager& manager, std::span<const Operation> operations) {
+  ReplayReport report;
+  for (const auto& operation : operations) {
+    ++report.operations[static_cast<size_t>(operation.type)].count;
+  }
+  for (auto& stats : report.operations) {
+    stats.nanos.reserve(stats.count);
+  }
+
+  auto start = Clock::now();
+  for (const auto& operation : operations) {
+    std::optional<Book> book;
+    if (operation.type == OperationType::Add) {
+      if (auto fields = parseAddFields(operation.text)) {
+        book = std::move(*fields);
+      }
+    }
+
+    auto begin = Clock::now();
+    bool accepted = run(manager, operation, book);
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin);
+
+    OperationStats& stats = report.operations[static_cast<size_t>(operation.type)];
+    stats.nanos.push_back(static_cast<uint64_t>(elapsed.count()));
+    if (!accepted) {
+      ++stats.rejected;
+    }
+  }
+  report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  for (auto& stats : report.operations) {
+    std::sort(stats.nanos.begin(), stats.nanos.end());
+  }
+  return report;
+}
@@ -0,0 +1,58 @@
+#include "book_record.h"
+#include "gtest/gtest.h"
+
+// Test that a record round-trips, including characters that need escaping
+TEST(BookRecordTest, RoundTrip) {
+  Book book(7, "Tabs\tand\\slashes", "Line\nBreak\r", "978-0321563842", 2013, "Programming");
+  book.setStatus(BookStatus::Borrowed);
+
+  std::string line;
+  appendBookRecord(book, line);
+  ASSERT_EQ(line.find('\n'), line.size() - 1);
+  EXPECT_EQ(line,
+            "7\tTabs\\tand\\\\slashes\tLine\\nBreak\\r\t978-0321563842\t2013\t"
+            "Programming\tBorrowed\n");
+
+  line.pop_back();
+  auto parsed = parseBookRecord(line);
+  ASSERT_TRUE(parsed.has_value());
+  EXPECT_EQ(parsed->getBookID(), 7);
+  EXPECT_EQ(parsed->getTitle(), book.getTitle());
+  EXPECT_EQ(parsed->getAuthor(), book.getAuthor());
+  EXPECT_EQ(parsed->getISBN(), book.getISBN());
+  EXPECT_EQ(parsed->getPublicationYear(), 2013);
+  EXPECT_EQ(parsed->getCategory(), "Programming");
+  EXPECT_EQ(parsed->getStatus(), BookStatus::Borrowed);
+}
+
+// Test that malformed records are rejected
+TEST(BookRecordTest, Malformed) {
+  EXPECT_FALSE(parseBookRecord("").has_value());
+  EXPECT_FALSE(parseBookRecord("1\tTitle\tAuthor\t\t\tGeneral").has_value());
+  EXPECT_FALSE(parseBookRecord("x\tTitle\tAuthor\t\t\tGeneral\tAvailable").has_value());
+  EXPECT_FALSE(parseBookRecord("1\tTitle\tAuthor\t\tsoon\tGeneral\tAvailable").has_value());
+  EXPECT_FALSE(parseBookRecord("1\tTitle\tAuthor\t\t\tGeneral\tLost").has_value());
+  EXPECT_FALSE(parseBookRecord("1\tTitle\tAuthor\t\t\tGeneral\tAvailable\textra").has_value());
+  EXPECT_TRUE(parseBookRecord("1\tTitle\tAuthor\t\t\tGeneral\tAvailable").has_value());
+}
+
+// Test ADD field decoding and its defaults
+TEST(BookRecordTest, AddFields) {
+  auto full = parseAddFields("Design Patterns\tGang of Four\t978-0201633610\t1994\tSoftware");
+  ASSERT_TRUE(full.has_value());
+  EXPECT_EQ(full->getTitle(), "Design Patterns");
+  EXPECT_EQ(full->getISBN(), "978-0201633610");
+  EXPECT_EQ(full->getPublicationYear(), 1994);
+  EXPECT_EQ(full->getCategory(), "Software");
+
+  auto minimal = parseAddFields(" Tab\\there \t Author ");
+  ASSERT_TRUE(minimal.has_value());
+  EXPECT_EQ(minimal->getTitle(), "Tab\there");
+  EXPECT_EQ(minimal->getAuthor(), "Author");
+  EXPECT_EQ(minimal->getISBN(), "");
+  EXPECT_FALSE(minimal->getPublicationYear().has_value());
+  EXPECT_EQ(minimal->getCategory(), "General");
+
+  EXPECT_EQ(parseAddFields("Title only").error(), "title and author are required");
+  EXPECT_EQ(parseAddFields("Title\tAuthor\t\tsoon").error(), "invalid publication year");
+}
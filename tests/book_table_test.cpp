@@ -0,0 +1,135 @@
+#include "gtest/gtest.h"
+#include "book_table.h"
+
+// Test insert, find and erase
+TEST(BookTableTest, InsertFindErase) {
+  BookTable table;
+  table.insert(Book(1, "Book 1", "Author 1"));
+  table.insert(Book(200, "Book 200", "Author 200"));
+
+  EXPECT_EQ(table.size(), 2);
+  ASSERT_TRUE(table.find(200).has_value());
+  EXPECT_EQ(table.find(200)->getTitle(), "Book 200");
+  EXPECT_FALSE(table.contains(2));
+  EXPECT_FALSE(table.contains(100000));
+
+  EXPECT_TRUE(table.erase(1));
+  EXPECT_FALSE(table.erase(1));
+  EXPECT_EQ(table.size(), 1);
+  EXPECT_FALSE(table.contains(1));
+}
+
+// Test that iteration follows ID order
+TEST(BookTableTest, ForEachInIdOrder) {
+  BookTable table;
+  for (unsigned int id : {300U, 5U, 64U, 63U}) {
+    table.insert(Book(id, "Title", "Author"));
+  }
+
+  std::vector<unsigned int> ids;
+  table.forEach([&ids](const BookView& book) { ids.push_back(book.getBookID()); });
+  EXPECT_EQ(ids, (std::vector<unsigned int>{5, 63, 64, 300}));
+
+  // Resume after 63 and stop once two books were seen
+  ids.clear();
+  EXPECT_FALSE(table.forEachFrom(64, [&ids](const BookView& book) {
+    ids.push_back(book.getBookID());
+    return ids.size() < 2;
+  }));
+  EXPECT_EQ(ids, (std::vector<unsigned int>{64, 300}));
+  EXPECT_TRUE(table.forEachFrom(6, [](const BookView&) { return true; }));
+  EXPECT_TRUE(table.forEachFrom(301, [](const BookView&) { return false; }));
+}
+
+// Test that copies are isolated from later writes
+TEST(BookTableTest, CopyOnWrite) {
+  BookTable table;
+  for (unsigned int id = 1; id <= 200; ++id) {
+    table.insert(Book(id, "Title", "Author"));
+  }
+
+  BookTable copy = table;
+  table.setStatus(10, BookStatus::Borrowed);
+  table.erase(150);
+  table.insert(Book(201, "New", "Author"));
+
+  EXPECT_TRUE(copy.find(10)->isAvailable());
+  EXPECT_TRUE(table.find(10)->isBorrowed());
+  EXPECT_TRUE(copy.contains(150));
+  EXPECT_FALSE(copy.contains(201));
+  EXPECT_EQ(copy.size(), 200);
+  EXPECT_EQ(table.size(), 200);
+}
+
+// Test that compaction trims the directory and leaves copies intact
+TEST(BookTableTest, Compact) {
+  BookTable table;
+  for (unsigned int id = 1; id <= 10000; ++id) {
+    table.insert(Book(id, "Title", "Author"));
+  }
+  BookTable copy = table;
+  for (unsigned int id = 101; id <= 10000; ++id) {
+    table.erase(id);
+  }
+  EXPECT_EQ(table.lastBookID(), 100);
+
+  size_t before = table.memoryUsage().total();
+  table.compact();
+  EXPECT_LT(table.memoryUsage().total(), before);
+  EXPECT_EQ(table.size(), 100);
+  EXPECT_TRUE(table.contains(100));
+  EXPECT_EQ(copy.size(), 10000);
+  EXPECT_TRUE(copy.contains(10000));
+
+  table.insert(Book(5000, "Title", "Author"));
+  EXPECT_EQ(table.lastBookID(), 5000);
+  EXPECT_EQ(copy.find(5000)->getTitle(), "Title");
+}
+
+// Test that the packed layout round-trips every field
+TEST(BookTableTest, PackedFields) {
+  BookTable table;
+  Book book(7, "Title", "Author", "978-0321563842", 2013, "Programming");
+  book.setStatus(BookStatus::UnderMaintenance);
+  table.insert(book);
+  table.insert(Book(8, "", "", "", std::nullopt, "Programming"));
+  table.insert(Book(9, "Far Future", "Author", "", 4000000000U));
+
+  auto view = table.find(7);
+  ASSERT_TRUE(view.has_value());
+  EXPECT_EQ(view->getTitle(), "Title");
+  EXPECT_EQ(view->getAuthor(), "Author");
+  EXPECT_EQ(view->getISBN(), "978-0321563842");
+  EXPECT_EQ(view->getPublicationYear(), 2013);
+  EXPECT_EQ(view->getCategory(), "Programming");
+  EXPECT_EQ(view->getStatus(), BookStatus::UnderMaintenance);
+
+  Book copy = table.find(8)->toBook();
+  EXPECT_EQ(copy.getTitle(), "");
+  EXPECT_FALSE(copy.getPublicationYear().has_value());
+  EXPECT_EQ(copy.getStatus(), BookStatus::Available);
+  EXPECT_EQ(table.find(9)->getPublicationYear(), 4000000000U);
+
+  table.setStatus(8, BookStatus::Borrowed);
+  EXPECT_TRUE(table.find(8)->isBorrowed());
+  EXPECT_FALSE(table.find(8)->getPublicationYear().has_value());
+}
+
+// Test that compaction drops replaced text while copies keep reading theirs
+TEST(BookTableTest, CompactStrings) {
+  BookTable table;
+  for (unsigned int id = 1; id <= 1000; ++id) {
+    table.insert(Book(id, "Original title " + std::to_string(id), "Author", "", 2000, "Fiction"));
+  }
+  BookTable copy = table;
+  for (unsigned int id = 1; id <= 1000; ++id) {
+    table.insert(Book(id, "Replaced " + std::to_string(id), "Author", "", 2000, "Fiction"));
+  }
+  EXPECT_GT(table.memoryUsage().string_garbage, 0);
+
+  table.compact();
+  EXPECT_EQ(table.memoryUsage().string_garbage, 0);
+  EXPECT_EQ(table.find(500)->getTitle(), "Replaced 500");
+  EXPECT_EQ(table.find(500)->getCategory(), "Fiction");
+  EXPECT_EQ(copy.find(500)->getTitle(), "Original title 500");
+}
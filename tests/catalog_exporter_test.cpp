@@ -0,0 +1,71 @@
+#include "catalog_exporter.h"
+#include "gtest/gtest.h"
+#include "library_manager.h"
+
+#include <algorithm>
+#include <sstream>
+
+class CatalogExporterTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    (void)manager.addBook("Design Patterns", "Gang of Four", "978-0201633610", 1994, "Software");
+    (void)manager.addBook("Say \"Hello\", World", "A\\B", "", std::nullopt, "Fiction");
+    (void)manager.addBook("Line\nBreak", "Author", "", 2001, "Software");
+    (void)manager.borrowBook(3);
+  }
+
+  std::string exportCatalog(const ExportOptions& options) {
+    std::ostringstream out;
+    CatalogExporter exporter(options);
+    stats = exporter.write(manager.snapshot(), out);
+    return out.str();
+  }
+
+  LibraryManager manager;
+  ExportStats stats;
+};
+
+// Test CSV quoting
+TEST_F(CatalogExporterTest, Csv) {
+  EXPECT_EQ(exportCatalog({}),
+            "id,title,author,isbn,year,category,status\n"
+            "1,Design Patterns,Gang of Four,978-0201633610,1994,Software,Available\n"
+            "2,\"Say \"\"Hello\"\", World\",A\\B,,,Fiction,Available\n"
+            "3,\"Line\nBreak\",Author,,2001,Software,Borrowed\n");
+  EXPECT_EQ(stats.rows, 3);
+}
+
+// Test JSON Lines escaping and filters
+TEST_F(CatalogExporterTest, JsonLinesWithFilters) {
+  ExportOptions options;
+  options.format = ExportFormat::JsonLines;
+  options.category = "Fiction";
+  EXPECT_EQ(exportCatalog(options),
+            "{\"id\":2,\"title\":\"Say \\\"Hello\\\", World\",\"author\":\"A\\\\B\","
+            "\"isbn\":\"\",\"year\":null,\"category\":\"Fiction\",\"status\":\"Available\"}\n");
+
+  options.category = "Software";
+  options.status = BookStatus::Borrowed;
+  EXPECT_EQ(exportCatalog(options),
+            "{\"id\":3,\"title\":\"Line\\nBreak\",\"author\":\"Author\",\"isbn\":\"\","
+            "\"year\":2001,\"category\":\"Software\",\"status\":\"Borrowed\"}\n");
+  EXPECT_EQ(stats.rows, 1);
+}
+
+// Test that output spanning many buffer flushes stays complete and in ID order
+TEST_F(CatalogExporterTest, ManyFlushes) {
+  for (int i = 0; i < 5000; ++i) {
+    (void)manager.addBook("Book " + std::to_string(i), "Author");
+  }
+
+  ExportOptions options;
+  options.buffer_size = 4096;
+  std::string csv = exportCatalog(options);
+
+  EXPECT_EQ(stats.rows, 5003);
+  EXPECT_EQ(stats.bytes, csv.size());
+  EXPECT_EQ(std::count(csv.begin(), csv.end(), '\n'), 5005); // header and embedded newline
+  EXPECT_TRUE(csv.ends_with("5003,Book 4999,Author,,,General,Available\n"));
+  EXPECT_EQ(CatalogExporter::parseFormat("jsonl"), ExportFormat::JsonLines);
+  EXPECT_FALSE(CatalogExporter::parseFormat("xml").has_value());
+}
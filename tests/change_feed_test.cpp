@@ -0,0 +1,63 @@
+#include "gtest/gtest.h"
+#include "change_feed.h"
+
+#include <thread>
+
+namespace {
+
+ChangeEvent borrowEvent(uint64_t sequence) {
+  auto book_id = static_cast<unsigned int>(sequence);
+  return ChangeEvent{sequence, ChangeType::Borrow, book_id, std::nullopt};
+}
+
+} // namespace
+
+// Test pulling batches in order
+TEST(ChangeFeedTest, PullBatches) {
+  ChangeFeed feed(8);
+  for (uint64_t seq = 1; seq <= 5; ++seq) {
+    feed.append(borrowEvent(seq));
+  }
+
+  auto batch = feed.pull(1, 3);
+  ASSERT_EQ(batch.events.size(), 3);
+  EXPECT_EQ(batch.events.front().sequence, 1);
+  EXPECT_EQ(batch.next_sequence, 4);
+  EXPECT_FALSE(batch.overrun);
+
+  batch = feed.pull(batch.next_sequence, 10);
+  ASSERT_EQ(batch.events.size(), 2);
+  EXPECT_EQ(batch.events.back().sequence, 5);
+  EXPECT_EQ(batch.next_sequence, 6);
+
+  batch = feed.pull(batch.next_sequence, 10);
+  EXPECT_TRUE(batch.events.empty());
+  EXPECT_EQ(batch.next_sequence, 6);
+}
+
+// Test that slow consumers are told about dropped events
+TEST(ChangeFeedTest, Overrun) {
+  ChangeFeed feed(4);
+  for (uint64_t seq = 1; seq <= 10; ++seq) {
+    feed.append(borrowEvent(seq));
+  }
+
+  EXPECT_EQ(feed.oldestSequence(), 7);
+  EXPECT_EQ(feed.lastSequence(), 10);
+
+  auto batch = feed.pull(2, 100);
+  EXPECT_TRUE(batch.overrun);
+  ASSERT_EQ(batch.events.size(), 4);
+  EXPECT_EQ(batch.events.front().sequence, 7);
+  EXPECT_EQ(batch.next_sequence, 11);
+}
+
+// Test waiting for new events from another thread
+TEST(ChangeFeedTest, WaitFor) {
+  ChangeFeed feed(4);
+  EXPECT_FALSE(feed.waitFor(1, std::chrono::milliseconds(1)));
+
+  std::thread writer([&feed] { feed.append(borrowEvent(1)); });
+  EXPECT_TRUE(feed.waitFor(1, std::chrono::seconds(5)));
+  writer.join();
+}
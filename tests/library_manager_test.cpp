@@ -168,3 +168,268 @@ TEST_F(LibraryManagerTest, Statistics) {
   EXPECT_EQ(manager.getTotalBooks(), 3);
   EXPECT_EQ(manager.getAvailableBooks(), 1);
 }
+
+// Test facet counts over the whole catalog
+TEST_F(LibraryManagerTest, FacetCounts) {
+  unsigned int id1 = manager.addBook("Book 1", "Author 1", "", 1994, "Fiction");
+  (void)manager.addBook("Book 2", "Author 2", "", 1999, "Science");
+  (void)manager.addBook("Book 3", "Author 3", "", 2013, "Fiction");
+  (void)manager.addBook("Book 4", "Author 4");
+  EXPECT_TRUE(manager.borrowBook(id1));
+
+  auto counts = manager.getFacetCounts();
+  EXPECT_EQ(counts.by_category["Fiction"], 2);
+  EXPECT_EQ(counts.by_category["Science"], 1);
+  EXPECT_EQ(counts.by_category["General"], 1);
+  EXPECT_EQ(counts.by_status[BookStatus::Available], 3);
+  EXPECT_EQ(counts.by_status[BookStatus::Borrowed], 1);
+  EXPECT_EQ(counts.by_decade[1990], 2);
+  EXPECT_EQ(counts.by_decade[2010], 1);
+  EXPECT_EQ(counts.by_decade.size(), 2);
+}
+
+// Test facet counts over a search result set
+TEST_F(LibraryManagerTest, FacetCountsForSearchResults) {
+  unsigned int id1 = manager.addBook("C++ Primer", "Author 1", "", 2012, "Programming");
+  (void)manager.addBook("C++ Poetry", "Author 2", "", 2001, "Fiction");
+  unsigned int id3 = manager.addBook("Rust in Action", "Author 3", "", 2021, "Programming");
+  EXPECT_TRUE(manager.borrowBook(id1));
+  EXPECT_TRUE(manager.removeBook(id3));
+
+  auto counts = manager.getFacetCounts(manager.searchByTitle("C++"));
+  EXPECT_EQ(counts.by_category.size(), 2);
+  EXPECT_EQ(counts.by_category["Programming"], 1);
+  EXPECT_EQ(counts.by_category["Fiction"], 1);
+  EXPECT_EQ(counts.by_status[BookStatus::Borrowed], 1);
+  EXPECT_EQ(counts.by_status[BookStatus::Available], 1);
+  EXPECT_EQ(counts.by_decade.count(2020), 0);
+
+  EXPECT_TRUE(manager.returnBook(id1));
+  EXPECT_EQ(manager.getFacetCounts().by_status.count(BookStatus::Borrowed), 0);
+}
+
+// Test that any year round-trips and leaves the decade facet consistent on removal
+TEST_F(LibraryManagerTest, LargePublicationYear) {
+  unsigned int book_id = manager.addBook("Far Future", "Author", "", 999999999);
+  EXPECT_EQ(manager.getBook(book_id)->getPublicationYear(), 999999999);
+  EXPECT_EQ(manager.getFacetCounts().by_decade[999999990], 1);
+
+  EXPECT_TRUE(manager.removeBook(book_id));
+  EXPECT_TRUE(manager.getFacetCounts().by_decade.empty());
+}
+
+// Test ranked search
+TEST_F(LibraryManagerTest, SearchRanked) {
+  (void)manager.addBook("Python Programming", "Author 1");
+  unsigned int id2 = manager.addBook("The C++ Programming Language", "Bjarne Stroustrup");
+  unsigned int id3 = manager.addBook("Effective Modern C++", "Scott Meyers");
+  (void)manager.addBook("Tour of C++", "Bjarne Stroustrup");
+
+  auto results = manager.searchRanked("c++ stroustrup", 2);
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].getAuthor(), "Bjarne Stroustrup");
+  EXPECT_EQ(results[1].getAuthor(), "Bjarne Stroustrup");
+
+  EXPECT_TRUE(manager.removeBook(id2));
+  EXPECT_TRUE(manager.updateBook(id3, "Effective Modern Rust", "Scott Meyers"));
+  results = manager.searchRanked("C++");
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0].getTitle(), "Tour of C++");
+}
+
+// Test query cache hits and invalidation by mutations
+TEST_F(LibraryManagerTest, QueryCache) {
+  manager.enableQueryCache(16);
+  unsigned int id = manager.addBook("C++ Programming", "Author 1");
+  (void)manager.addBook("Python Programming", "Author 2");
+
+  EXPECT_EQ(manager.searchByTitle("C++").size(), 1);
+  EXPECT_EQ(manager.searchByTitle("C++").size(), 1);
+  EXPECT_EQ(manager.getQueryCacheStats().hits, 1);
+
+  // Status changes do not affect title matches but show up in the returned books
+  EXPECT_TRUE(manager.borrowBook(id));
+  auto results = manager.searchByTitle("C++");
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_TRUE(results[0].isBorrowed());
+  EXPECT_EQ(manager.getQueryCacheStats().hits, 2);
+
+  (void)manager.addBook("C++ Advanced", "Author 3");
+  EXPECT_EQ(manager.searchByTitle("C++").size(), 2);
+
+  EXPECT_TRUE(manager.updateBook(id, "Java Programming", "Author 1"));
+  EXPECT_EQ(manager.searchByTitle("C++").size(), 1);
+  EXPECT_EQ(manager.searchRanked("programming").size(), 2);
+  EXPECT_EQ(manager.searchRanked("Programming").size(), 2);
+
+  auto stats = manager.getQueryCacheStats();
+  EXPECT_EQ(stats.hits, 3);
+  EXPECT_EQ(stats.invalidations, 2);
+
+  manager.disableQueryCache();
+  EXPECT_EQ(manager.getQueryCacheStats().capacity, 0);
+}
+
+// Test that snapshots are unaffected by later writes
+TEST_F(LibraryManagerTest, Snapshot) {
+  unsigned int id1 = manager.addBook("Book 1", "Author 1");
+  unsigned int id2 = manager.addBook("Book 2", "Author 2");
+
+  CatalogSnapshot snapshot = manager.snapshot();
+
+  EXPECT_TRUE(manager.borrowBook(id1));
+  EXPECT_TRUE(manager.removeBook(id2));
+  EXPECT_TRUE(manager.updateBook(id1, "Renamed", "Author 1"));
+  (void)manager.addBook("Book 3", "Author 3");
+
+  EXPECT_EQ(snapshot.getTotalBooks(), 2);
+  EXPECT_EQ(snapshot.getAvailableBooks(), 2);
+  ASSERT_TRUE(snapshot.getBook(id1).has_value());
+  EXPECT_EQ(snapshot.getBook(id1)->getTitle(), "Book 1");
+  EXPECT_TRUE(snapshot.getBook(id1)->isAvailable());
+  EXPECT_TRUE(snapshot.getBook(id2).has_value());
+  EXPECT_EQ(snapshot.getAllBooks().size(), 2);
+
+  EXPECT_EQ(manager.getTotalBooks(), 2);
+  EXPECT_EQ(manager.getBook(id1)->getTitle(), "Renamed");
+}
+
+// Test that mutations are recorded in the change feed
+TEST_F(LibraryManagerTest, ChangeFeed) {
+  manager.enableChangeFeed(16);
+  unsigned int id = manager.addBook("Book 1", "Author 1");
+  EXPECT_TRUE(manager.borrowBook(id));
+  EXPECT_FALSE(manager.borrowBook(id));
+  EXPECT_TRUE(manager.returnBook(id));
+  EXPECT_TRUE(manager.updateBook(id, "Book 1, 2nd ed.", "Author 1"));
+  EXPECT_TRUE(manager.removeBook(id));
+
+  auto feed = manager.getChangeFeed();
+  ASSERT_NE(feed, nullptr);
+  EXPECT_EQ(manager.getChangeSequence(), 5);
+
+  auto batch = feed->pull(1, 16);
+  ASSERT_EQ(batch.events.size(), 5);
+  EXPECT_EQ(batch.events[0].type, ChangeType::Add);
+  ASSERT_TRUE(batch.events[0].book.has_value());
+  EXPECT_EQ(batch.events[0].book->getTitle(), "Book 1");
+  EXPECT_EQ(batch.events[1].type, ChangeType::Borrow);
+  EXPECT_EQ(batch.events[2].type, ChangeType::Return);
+  EXPECT_EQ(batch.events[3].type, ChangeType::Update);
+  EXPECT_EQ(batch.events[3].book->getTitle(), "Book 1, 2nd ed.");
+  EXPECT_EQ(batch.events[4].type, ChangeType::Remove);
+  EXPECT_EQ(batch.events[4].book_id, id);
+  EXPECT_EQ(manager.snapshot().getSequence(), 5);
+}
+
+// Test that replaying a change feed onto another manager reproduces the catalog
+TEST_F(LibraryManagerTest, ApplyChanges) {
+  manager.enableChangeFeed(16);
+  LibraryManager replica;
+  replica.loadCatalog(manager.getAllBooks(), manager.getChangeSequence());
+
+  unsigned int id1 = manager.addBook("Book 1", "Author 1", "111", 2001, "Fiction");
+  unsigned int id2 = manager.addBook("Book 2", "Author 2");
+  ASSERT_TRUE(manager.borrowBook(id1));
+  ASSERT_TRUE(manager.updateBook(id2, "Book 2, 2nd ed.", "Author 2"));
+  ASSERT_TRUE(manager.removeBook(id2));
+
+  for (const auto& event : manager.getChangeFeed()->pull(1, 16).events) {
+    replica.applyChange(event);
+  }
+
+  EXPECT_EQ(replica.getChangeSequence(), manager.getChangeSequence());
+  ASSERT_EQ(replica.getTotalBooks(), 1);
+  EXPECT_EQ(replica.getBook(id1)->getStatus(), BookStatus::Borrowed);
+  EXPECT_EQ(replica.searchByCategory("Fiction").size(), 1);
+  EXPECT_EQ(replica.getAvailableBooks(), 0);
+  EXPECT_EQ(replica.addBook("Book 3", "Author 3"), manager.addBook("Book 3", "Author 3"));
+}
+
+// Test that loading a catalog replaces the previous contents
+TEST_F(LibraryManagerTest, LoadCatalog) {
+  (void)manager.addBook("Old Book", "Old Author");
+
+  std::vector<Book> books = {Book(4, "C++ Programming", "Author 1"),
+                             Book(9, "Python Programming", "Author 2")};
+  books[1].setStatus(BookStatus::Borrowed);
+  manager.loadCatalog(books, 42);
+
+  EXPECT_EQ(manager.getChangeSequence(), 42);
+  EXPECT_EQ(manager.getTotalBooks(), 2);
+  EXPECT_EQ(manager.getAvailableBooks(), 1);
+  EXPECT_TRUE(manager.searchByTitle("Old").empty());
+  EXPECT_EQ(manager.searchRanked("programming").size(), 2);
+  EXPECT_EQ(manager.addBook("New Book", "Author 3"), 10);
+}
+
+// Test that retired IDs are reused lowest first once enabled
+TEST_F(LibraryManagerTest, IdReuse) {
+  for (int i = 0; i < 5; ++i) {
+    (void)manager.addBook("Book", "Author");
+  }
+  EXPECT_TRUE(manager.removeBook(2));
+  EXPECT_EQ(manager.addBook("Book", "Author"), 6);
+
+  manager.setIdPolicy(IdPolicy::ReuseRetired);
+  EXPECT_TRUE(manager.removeBook(4));
+  EXPECT_EQ(manager.addBook("Book", "Author"), 2);
+  EXPECT_EQ(manager.addBook("Book", "Author"), 4);
+  EXPECT_EQ(manager.addBook("Book", "Author"), 7);
+
+  manager.setIdPolicy(IdPolicy::Monotonic);
+  EXPECT_TRUE(manager.removeBook(3));
+  EXPECT_EQ(manager.addBook("Book", "Author"), 8);
+}
+
+// Test that compaction shrinks storage after a large removal
+TEST_F(LibraryManagerTest, Compact) {
+  manager.setIdPolicy(IdPolicy::ReuseRetired);
+  for (int i = 0; i < 20000; ++i) {
+    (void)manager.addBook("Book " + std::to_string(i),
+                          "Author " + std::to_string(i % 100),
+                          "",
+                          1950 + i % 70,
+                          "Category " + std::to_string(i % 20));
+  }
+  for (unsigned int id = 1001; id <= 20000; ++id) {
+    EXPECT_TRUE(manager.removeBook(id));
+  }
+  EXPECT_TRUE(manager.removeBook(10));
+
+  CompactionReport report = manager.compact();
+  EXPECT_LT(report.after.total(), report.before.total());
+  EXPECT_LT(report.after.book_records, report.before.book_records);
+  EXPECT_LT(report.after.book_strings, report.before.book_strings);
+  EXPECT_GT(report.before.string_garbage, 0);
+  EXPECT_EQ(report.after.string_garbage, 0);
+  EXPECT_LT(report.after.search_index, report.before.search_index);
+  EXPECT_LT(report.after.free_ids, report.before.free_ids);
+  EXPECT_EQ(report.after.total(), manager.getMemoryUsage().total());
+
+  EXPECT_EQ(manager.getTotalBooks(), 999);
+  EXPECT_EQ(manager.searchRanked("book 999").front().getBookID(), 1000);
+  EXPECT_EQ(manager.addBook("New", "Author"), 10);
+  EXPECT_EQ(manager.addBook("New", "Author"), 1001);
+}
+
+// Test memory accounting by component
+TEST_F(LibraryManagerTest, MemoryUsage) {
+  EXPECT_EQ(manager.getMemoryUsage().bytesPerBook(), 0.0);
+
+  for (int i = 0; i < 1000; ++i) {
+    (void)manager.addBook("Book " + std::to_string(i), "Author", "", 2000, "Fiction");
+  }
+  CatalogMemoryUsage usage = manager.getMemoryUsage();
+
+  EXPECT_EQ(usage.books, 1000);
+  EXPECT_GT(usage.book_records, 0);
+  EXPECT_GT(usage.book_strings, 0);
+  EXPECT_GT(usage.facet_indexes, 0);
+  EXPECT_GT(usage.search_index, 0);
+  EXPECT_EQ(usage.string_garbage, 0);
+  EXPECT_DOUBLE_EQ(usage.bytesPerBook(), static_cast<double>(usage.total()) / 1000.0);
+
+  EXPECT_TRUE(manager.updateBook(1, "Renamed", "Author"));
+  EXPECT_GT(manager.getMemoryUsage().string_garbage, 0);
+}
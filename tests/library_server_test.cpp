@@ -0,0 +1,165 @@
+#ifdef LMS_HAS_SERVER
+
+#include "gtest/gtest.h"
+#include "library_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace {
+
+int connectLoopback(uint16_t port) {
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+void sendAll(int fd, std::string_view data) {
+  while (!data.empty()) {
+    ssize_t sent = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    ASSERT_GT(sent, 0);
+    data.remove_prefix(static_cast<size_t>(sent));
+  }
+}
+
+// Reads until the peer closes the connection
+std::string receiveAll(int fd) {
+  std::string data;
+  char buffer[4096];
+  ssize_t received;
+  while ((received = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+    data.append(buffer, static_cast<size_t>(received));
+  }
+  return data;
+}
+
+} // namespace
+
+class LibraryServerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    (void)manager.addBook("C++ Programming", "Author 1");
+    server = std::make_unique<LibraryServer>(manager, "127.0.0.1", 0);
+    thread = std::thread([this] { server->run(); });
+  }
+
+  void TearDown() override {
+    server->stop();
+    thread.join();
+  }
+
+  LibraryManager manager;
+  std::unique_ptr<LibraryServer> server;
+  std::thread thread;
+};
+
+// Test pipelined requests on a single connection
+TEST_F(LibraryServerTest, PipelinedRequests) {
+  int fd = connectLoopback(server->port());
+  ASSERT_GE(fd, 0);
+
+  sendAll(fd, "ADD Rust in Action\tTim McNamara\nBORROW 2\nGET 2\nSTATS\nNOPE\n");
+  ::shutdown(fd, SHUT_WR);
+  std::string responses = receiveAll(fd);
+  ::close(fd);
+
+  EXPECT_EQ(responses,
+            "OK 2\n"
+            "OK\n"
+            "OK 1\n2\tRust in Action\tTim McNamara\t\t\tGeneral\tBorrowed\n"
+            "OK total=2 available=1 borrowed=1\n"
+            "ERR unknown command\n");
+}
+
+// Test many concurrent connections and requests split across writes
+TEST_F(LibraryServerTest, ConcurrentConnections) {
+  constexpr int kClients = 16;
+  std::vector<int> fds;
+  for (int i = 0; i < kClients; ++i) {
+    int fd = connectLoopback(server->port());
+    ASSERT_GE(fd, 0);
+    fds.push_back(fd);
+  }
+
+  for (int fd : fds) {
+    sendAll(fd, "STA");
+  }
+  for (int fd : fds) {
+    sendAll(fd, "TS\nGET 1\n");
+    ::shutdown(fd, SHUT_WR);
+  }
+  for (int fd : fds) {
+    EXPECT_EQ(receiveAll(fd),
+              "OK total=1 available=1 borrowed=0\n"
+              "OK 1\n1\tC++ Programming\tAuthor 1\t\t\tGeneral\tAvailable\n");
+    ::close(fd);
+  }
+}
+
+// Test that a large pipelined burst is answered completely
+TEST_F(LibraryServerTest, LargeBurst) {
+  int fd = connectLoopback(server->port());
+  ASSERT_GE(fd, 0);
+
+  constexpr int kRequests = 20000;
+  std::string burst;
+  for (int i = 0; i < kRequests; ++i) {
+    burst += "GET 1\n";
+  }
+
+  std::string responses;
+  std::thread reader([&] { responses = receiveAll(fd); });
+  sendAll(fd, burst);
+  ::shutdown(fd, SHUT_WR);
+  reader.join();
+  ::close(fd);
+
+  std::string expected = "OK 1\n1\tC++ Programming\tAuthor 1\t\t\tGeneral\tAvailable\n";
+  EXPECT_EQ(responses.size(), expected.size() * kRequests);
+}
+
+// Test that requests from a client that does not read are held back at the output cap
+TEST_F(LibraryServerTest, PendingOutputIsBounded) {
+  // The server thread only touches the manager while answering requests
+  for (int i = 0; i < 2000; ++i) {
+    (void)manager.addBook("Book " + std::to_string(i), "Author");
+  }
+  int fd = connectLoopback(server->port());
+  ASSERT_GE(fd, 0);
+
+  // Each response is about 80 KB, so the whole burst would queue about 50 MB
+  constexpr int kRequests = 600;
+  std::string burst;
+  for (int i = 0; i < kRequests; ++i) {
+    burst += "SEARCH TITLE Book\n";
+  }
+  sendAll(fd, burst);
+  ::shutdown(fd, SHUT_WR);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_LT(server->peakPendingOutput(), LibraryServer::kMaxPendingOutput + 200 * 1024);
+
+  // Held-back requests are answered once the client catches up
+  std::string responses = receiveAll(fd);
+  ::close(fd);
+  size_t answered = 0;
+  for (size_t at = 0; (at = responses.find("OK 2000\n", at)) != std::string::npos; ++at) {
+    ++answered;
+  }
+  EXPECT_EQ(answered, kRequests);
+  EXPECT_LT(server->peakPendingOutput(), LibraryServer::kMaxPendingOutput + 200 * 1024);
+}
+
+#endif // LMS_HAS_SERVER
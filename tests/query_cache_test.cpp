@@ -0,0 +1,47 @@
+#include "gtest/gtest.h"
+#include "query_cache.h"
+
+// Test hits and misses
+TEST(QueryCacheTest, HitAndMiss) {
+  QueryCache cache(4);
+
+  EXPECT_EQ(cache.lookup("title:C++"), nullptr);
+  cache.store("title:C++", {1, 2}, {CatalogField::Membership, CatalogField::Title});
+
+  const QueryCache::Value* value = cache.lookup("title:C++");
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(*value, (std::vector<unsigned int>{1, 2}));
+
+  auto stats = cache.getStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.size, 1);
+}
+
+// Test generation-based invalidation
+TEST(QueryCacheTest, Invalidation) {
+  QueryCache cache(4);
+  cache.store("title:C++", {1}, {CatalogField::Membership, CatalogField::Title});
+
+  cache.bump(CatalogField::Status);
+  EXPECT_NE(cache.lookup("title:C++"), nullptr);
+
+  cache.bump(CatalogField::Title);
+  EXPECT_EQ(cache.lookup("title:C++"), nullptr);
+  EXPECT_EQ(cache.getStats().invalidations, 1);
+  EXPECT_EQ(cache.getStats().size, 0);
+}
+
+// Test LRU eviction
+TEST(QueryCacheTest, Eviction) {
+  QueryCache cache(2);
+  cache.store("a", {1}, {CatalogField::Membership});
+  cache.store("b", {2}, {CatalogField::Membership});
+  EXPECT_NE(cache.lookup("a"), nullptr);
+
+  cache.store("c", {3}, {CatalogField::Membership});
+  EXPECT_EQ(cache.lookup("b"), nullptr);
+  EXPECT_NE(cache.lookup("a"), nullptr);
+  EXPECT_NE(cache.lookup("c"), nullptr);
+  EXPECT_EQ(cache.getStats().evictions, 1);
+}
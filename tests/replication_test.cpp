@@ -0,0 +1,302 @@
+#ifdef LMS_HAS_SERVER
+
+#include "gtest/gtest.h"
+#include "library_server.h"
+#include "replication.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+// A forked lms process serving the line protocol on an ephemeral port
+struct ServerProcess {
+  pid_t pid{-1};
+  uint16_t port{0};
+};
+
+// Runs setup(manager, server) in a child process and serves until killed
+ServerProcess spawnServer(const std::function<void(LibraryManager&, LibraryServer&)>& setup) {
+  int pipe_fds[2];
+  if (::pipe(pipe_fds) < 0) {
+    return {};
+  }
+
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    ::close(pipe_fds[0]);
+    try {
+      LibraryManager manager;
+      LibraryServer server(manager, "127.0.0.1", 0);
+      setup(manager, server);
+      uint16_t port = server.port();
+      [[maybe_unused]] ssize_t ignored = ::write(pipe_fds[1], &port, sizeof(port));
+      ::close(pipe_fds[1]);
+      server.run();
+    } catch (...) {
+      ::_exit(1);
+    }
+    ::_exit(0);
+  }
+
+  ::close(pipe_fds[1]);
+  ServerProcess process{pid, 0};
+  if (::read(pipe_fds[0], &process.port, sizeof(process.port)) != sizeof(process.port)) {
+    process.port = 0;
+  }
+  ::close(pipe_fds[0]);
+  return process;
+}
+
+void killServer(const ServerProcess& process) {
+  if (process.pid > 0) {
+    ::kill(process.pid, SIGKILL);
+    ::waitpid(process.pid, nullptr, 0);
+  }
+}
+
+// Sends one request and returns the full response
+std::string request(uint16_t port, std::string_view line) {
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+    ::close(fd);
+    return {};
+  }
+
+  std::string data(line);
+  data += '\n';
+  ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+  ::shutdown(fd, SHUT_WR);
+
+  std::string response;
+  char buffer[4096];
+  ssize_t received;
+  while ((received = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+    response.append(buffer, static_cast<size_t>(received));
+  }
+  ::close(fd);
+  return response;
+}
+
+// Polls until the response matches or a deadline passes
+std::string awaitResponse(uint16_t port, std::string_view line, std::string_view expected) {
+  auto deadline = std::chrono::steady_clock::now() + 5s;
+  std::string response = request(port, line);
+  while (response != expected && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(10ms);
+    response = request(port, line);
+  }
+  return response;
+}
+
+} // namespace
+
+class ReplicationTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    socket_path = "/tmp/lms_replication_test_" + std::to_string(::getpid()) + ".sock";
+  }
+
+  void TearDown() override {
+    killServer(replica);
+    killServer(primary);
+    ::unlink(socket_path.c_str());
+  }
+
+  void startPrimary(size_t feed_capacity) {
+    std::string path = socket_path;
+    primary = spawnServer([path, feed_capacity](LibraryManager& manager, LibraryServer& server) {
+      (void)manager.addBook("C++ Programming", "Author 1", "111", 2013, "Programming");
+      (void)manager.addBook("Python Programming", "Author 2");
+      manager.enableChangeFeed(feed_capacity);
+
+      // Leaked on purpose: the process is killed, never returns
+      auto* publisher = new ReplicationPublisher(manager, path);
+      server.watch(publisher->fd(), [publisher] { publisher->handleEvents(); });
+      server.setTickHandler([publisher] { publisher->publish(); }, 10ms);
+    });
+  }
+
+  void startReplica() {
+    std::string path = socket_path;
+    replica = spawnServer([path](LibraryManager& manager, LibraryServer& server) {
+      auto* client = new ReplicationClient(manager, path);
+      server.setReadOnly(true);
+      server.setLagSource([client] { return client->lag(); });
+      server.watch(client->fd(), [client, &server] {
+        if (!client->poll()) {
+          server.unwatch(client->fd());
+        }
+      });
+    });
+  }
+
+  std::string socket_path;
+  ServerProcess primary;
+  ServerProcess replica;
+};
+
+// Test that a replica process bootstraps and then follows the primary process
+TEST_F(ReplicationTest, SnapshotThenDeltas) {
+  startPrimary(1024);
+  ASSERT_NE(primary.port, 0);
+  startReplica();
+  ASSERT_NE(replica.port, 0);
+
+  EXPECT_EQ(awaitResponse(replica.port, "STATS", "OK total=2 available=2 borrowed=0 lag=0\n"),
+            "OK total=2 available=2 borrowed=0 lag=0\n");
+
+  EXPECT_EQ(request(primary.port, "ADD Rust\\tin Action\tTim McNamara\t\t2021\tSystems"),
+            "OK 3\n");
+  EXPECT_EQ(request(primary.port, "BORROW 1"), "OK\n");
+
+  EXPECT_EQ(awaitResponse(replica.port, "STATS", "OK total=3 available=2 borrowed=1 lag=0\n"),
+            "OK total=3 available=2 borrowed=1 lag=0\n");
+  EXPECT_EQ(request(replica.port, "GET 3"), request(primary.port, "GET 3"));
+  EXPECT_EQ(request(replica.port, "SEARCH CATEGORY Systems"),
+            "OK 1\n3\tRust\\tin Action\tTim McNamara\t\t2021\tSystems\tAvailable\n");
+
+  EXPECT_EQ(request(replica.port, "BORROW 2"), "ERR read-only replica\n");
+}
+
+// Test that a replica outrunning the change feed is resynchronised with a snapshot
+TEST_F(ReplicationTest, ResyncAfterFeedOverrun) {
+  startPrimary(4);
+  ASSERT_NE(primary.port, 0);
+  startReplica();
+  ASSERT_NE(replica.port, 0);
+
+  std::string burst;
+  for (int i = 0; i < 50; ++i) {
+    burst += i % 2 == 0 ? "BORROW 2\n" : "RETURN 2\n";
+    burst += "ADD Book " + std::to_string(i) + "\tAuthor\n";
+  }
+  burst.pop_back();
+  std::string responses = request(primary.port, burst);
+  EXPECT_EQ(std::count(responses.begin(), responses.end(), '\n'), 100);
+
+  std::string expected = request(primary.port, "STATS");
+  expected.insert(expected.size() - 1, " lag=0");
+  EXPECT_EQ(expected, "OK total=52 available=52 borrowed=0 lag=0\n");
+  EXPECT_EQ(awaitResponse(replica.port, "STATS", expected), expected);
+  EXPECT_EQ(request(replica.port, "SEARCH TITLE Book 49"),
+            request(primary.port, "SEARCH TITLE Book 49"));
+}
+
+// Test bootstrap, deltas and lag tracking within one process
+TEST(ReplicationProtocolTest, LagTracking) {
+  std::string path = "/tmp/lms_replication_lag_" + std::to_string(::getpid()) + ".sock";
+  LibraryManager primary;
+  (void)primary.addBook("Book 1", "Author 1");
+  ReplicationPublisher publisher(primary, path);
+
+  LibraryManager replica;
+  ReplicationClient client(replica, path);
+  EXPECT_FALSE(client.isBootstrapped());
+
+  publisher.handleEvents();
+  ASSERT_EQ(publisher.replicaCount(), 1);
+  EXPECT_TRUE(client.poll());
+  EXPECT_TRUE(client.isBootstrapped());
+  EXPECT_EQ(client.appliedSequence(), 1);
+  EXPECT_EQ(client.lag(), 0);
+
+  (void)primary.addBook("Book 2", "Author 2");
+  ASSERT_TRUE(primary.borrowBook(1));
+  publisher.publish();
+  EXPECT_TRUE(client.poll());
+  EXPECT_EQ(client.primarySequence(), 3);
+  EXPECT_EQ(client.appliedSequence(), 3);
+  EXPECT_EQ(client.lag(), 0);
+  EXPECT_EQ(replica.getTotalBooks(), 2);
+  EXPECT_EQ(replica.getBook(1)->getStatus(), BookStatus::Borrowed);
+}
+
+// Test that a gap in the delta stream makes the replica reconnect for a new snapshot
+TEST(ReplicationProtocolTest, GapTriggersResync) {
+  std::string path = "/tmp/lms_replication_gap_" + std::to_string(::getpid()) + ".sock";
+  ::unlink(path.c_str());
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::copy(path.begin(), path.end(), address.sun_path);
+  int listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  ASSERT_EQ(::bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+  ASSERT_EQ(::listen(listen_fd, 4), 0);
+
+  // Stands in for a primary whose stream skips sequence 2
+  LibraryManager replica;
+  ReplicationClient client(replica, path);
+  int first = ::accept(listen_fd, nullptr, nullptr);
+  std::string_view stream = "SNAPSHOT 1 1\n1\tBook\tAuthor\t\t\tGeneral\tAvailable\n"
+                            "DELTA 3 BORROW 1\n";
+  ASSERT_EQ(::send(first, stream.data(), stream.size(), 0), static_cast<ssize_t>(stream.size()));
+
+  EXPECT_TRUE(client.poll());
+  EXPECT_EQ(client.resyncCount(), 1);
+  EXPECT_EQ(client.appliedSequence(), 1);
+  EXPECT_EQ(replica.getBook(1)->getStatus(), BookStatus::Available);
+
+  int second = ::accept(listen_fd, nullptr, nullptr);
+  ASSERT_GE(second, 0);
+  stream = "SNAPSHOT 3 1\n1\tBook\tAuthor\t\t\tGeneral\tBorrowed\n";
+  ASSERT_EQ(::send(second, stream.data(), stream.size(), 0), static_cast<ssize_t>(stream.size()));
+
+  EXPECT_TRUE(client.poll());
+  EXPECT_EQ(client.appliedSequence(), 3);
+  EXPECT_EQ(replica.getBook(1)->getStatus(), BookStatus::Borrowed);
+
+  ::close(first);
+  ::close(second);
+  ::close(listen_fd);
+  ::unlink(path.c_str());
+}
+
+// Test that a large snapshot is streamed in bounded chunks and that a replica
+// that goes away is dropped without waiting for the next publish
+TEST(ReplicationProtocolTest, StreamedSnapshot) {
+  std::string path = "/tmp/lms_replication_stream_" + std::to_string(::getpid()) + ".sock";
+  LibraryManager primary;
+  std::string title(200, 'x');
+  for (int i = 0; i < 40000; ++i) {
+    (void)primary.addBook(title + std::to_string(i), "Author");
+  }
+  ReplicationPublisher publisher(primary, path);
+
+  {
+    LibraryManager replica;
+    ReplicationClient client(replica, path);
+    size_t max_pending = 0;
+    auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (!client.isBootstrapped() && std::chrono::steady_clock::now() < deadline) {
+      publisher.handleEvents();
+      max_pending = std::max(max_pending, publisher.pendingOutput());
+      EXPECT_TRUE(client.poll());
+    }
+    ASSERT_TRUE(client.isBootstrapped());
+    EXPECT_EQ(replica.getTotalBooks(), 40000);
+    EXPECT_EQ(replica.getBook(40000)->getTitle(), title + "39999");
+    // The catalog is over 8 MiB; at most one record beyond the cap is queued
+    EXPECT_LE(max_pending, ReplicationPublisher::kMaxPendingOutput + 512);
+  }
+
+  publisher.handleEvents();
+  EXPECT_EQ(publisher.replicaCount(), 0);
+}
+
+#endif // LMS_HAS_SERVER
@@ -0,0 +1,85 @@
+#include "gtest/gtest.h"
+#include "request_handler.h"
+
+class RequestHandlerTest : public ::testing::Test {
+protected:
+  LibraryManager manager;
+  RequestHandler handler{manager};
+
+  std::string handle(std::string_view request) {
+    std::string out;
+    handler.handle(request, out);
+    return out;
+  }
+};
+
+// Test adding and getting a book
+TEST_F(RequestHandlerTest, AddAndGet) {
+  EXPECT_EQ(handle("ADD Design Patterns\tGang of Four\t978-0201633610\t1994\tSoftware"), "OK 1\n");
+  EXPECT_EQ(handle("ADD Minimal\tAuthor"), "OK 2\n");
+
+  EXPECT_EQ(handle("GET 1"),
+            "OK 1\n1\tDesign Patterns\tGang of Four\t978-0201633610\t1994\tSoftware\tAvailable\n");
+  EXPECT_EQ(handle("GET 2"), "OK 1\n2\tMinimal\tAuthor\t\t\tGeneral\tAvailable\n");
+  EXPECT_EQ(handle("GET 3"), "ERR book not found\n");
+}
+
+// Test search, borrow, return and stats
+TEST_F(RequestHandlerTest, SearchBorrowReturnStats) {
+  (void)manager.addBook("C++ Programming", "Author 1");
+  (void)manager.addBook("Python Programming", "Author 2");
+
+  EXPECT_EQ(handle("SEARCH TITLE C++"),
+            "OK 1\n1\tC++ Programming\tAuthor 1\t\t\tGeneral\tAvailable\n");
+  EXPECT_TRUE(handle("SEARCH RANKED programming").starts_with("OK 2\n"));
+  EXPECT_EQ(handle("SEARCH CATEGORY Fiction"), "OK 0\n");
+
+  EXPECT_EQ(handle("BORROW 1"), "OK\n");
+  EXPECT_EQ(handle("BORROW 1"), "ERR book not available for borrowing\n");
+  EXPECT_EQ(handle("STATS"), "OK total=2 available=1 borrowed=1\n");
+  EXPECT_EQ(handle("RETURN 1"), "OK\n");
+  EXPECT_EQ(handle("RETURN 1"), "ERR book was not borrowed or not found\n");
+}
+
+// Test that STATS counts only borrowed books as borrowed
+TEST_F(RequestHandlerTest, StatsByStatus) {
+  std::vector<Book> books;
+  for (unsigned int id = 1; id <= 4; ++id) {
+    books.emplace_back(id, "Title", "Author");
+  }
+  books[1].setStatus(BookStatus::Borrowed);
+  books[2].setStatus(BookStatus::Reserved);
+  books[3].setStatus(BookStatus::UnderMaintenance);
+  manager.loadCatalog(books, 4);
+
+  EXPECT_EQ(handle("STATS"), "OK total=4 available=1 borrowed=1\n");
+}
+
+// Test malformed requests
+TEST_F(RequestHandlerTest, MalformedRequests) {
+  EXPECT_EQ(handle("FROBNICATE"), "ERR unknown command\n");
+  EXPECT_EQ(handle("GET abc"), "ERR invalid book id\n");
+  EXPECT_EQ(handle("SEARCH ISBN 123"), "ERR unknown search field\n");
+  EXPECT_EQ(handle("ADD Title only"), "ERR title and author are required\n");
+  EXPECT_EQ(handle("ADD Title\tAuthor\t\tsoon"), "ERR invalid publication year\n");
+}
+
+// Test that a read-only handler rejects writes and reports lag
+TEST_F(RequestHandlerTest, ReadOnly) {
+  (void)manager.addBook("C++ Programming", "Author 1");
+  handler.setReadOnly(true);
+  handler.setLagSource([] { return uint64_t{3}; });
+
+  EXPECT_EQ(handle("ADD Title\tAuthor"), "ERR read-only replica\n");
+  EXPECT_EQ(handle("BORROW 1"), "ERR read-only replica\n");
+  EXPECT_EQ(handle("RETURN 1"), "ERR read-only replica\n");
+  EXPECT_TRUE(handle("GET 1").starts_with("OK 1\n"));
+  EXPECT_EQ(handle("STATS"), "OK total=1 available=1 borrowed=0 lag=3\n");
+}
+
+// Test the compaction request
+TEST_F(RequestHandlerTest, Compact) {
+  (void)manager.addBook("C++ Programming", "Author 1");
+  EXPECT_TRUE(handle("COMPACT").starts_with("OK bytes_before="));
+  EXPECT_TRUE(handle("GET 1").starts_with("OK 1\n"));
+}
@@ -0,0 +1,116 @@
+#include "gtest/gtest.h"
+#include "roaring_bitmap.h"
+
+// Test adding and querying values
+TEST(RoaringBitmapTest, AddAndContains) {
+  RoaringBitmap bitmap;
+  EXPECT_TRUE(bitmap.empty());
+
+  bitmap.add(1);
+  bitmap.add(70000);
+  bitmap.add(1);
+
+  EXPECT_EQ(bitmap.cardinality(), 2);
+  EXPECT_TRUE(bitmap.contains(1));
+  EXPECT_TRUE(bitmap.contains(70000));
+  EXPECT_FALSE(bitmap.contains(2));
+}
+
+// Test removing values
+TEST(RoaringBitmapTest, Remove) {
+  RoaringBitmap bitmap;
+  bitmap.add(5);
+  bitmap.add(6);
+
+  EXPECT_TRUE(bitmap.remove(5));
+  EXPECT_FALSE(bitmap.remove(5));
+  EXPECT_EQ(bitmap.cardinality(), 1);
+
+  EXPECT_TRUE(bitmap.remove(6));
+  EXPECT_TRUE(bitmap.empty());
+}
+
+// Test conversion between array and bitmap containers
+TEST(RoaringBitmapTest, DenseContainerConversion) {
+  RoaringBitmap bitmap;
+  for (uint32_t i = 0; i < 10000; ++i) {
+    bitmap.add(i * 2);
+  }
+  EXPECT_EQ(bitmap.cardinality(), 10000);
+  EXPECT_TRUE(bitmap.contains(19998));
+  EXPECT_FALSE(bitmap.contains(19999));
+
+  for (uint32_t i = 0; i < 9000; ++i) {
+    bitmap.remove(i * 2);
+  }
+  EXPECT_EQ(bitmap.cardinality(), 1000);
+  EXPECT_TRUE(bitmap.contains(18000));
+  EXPECT_FALSE(bitmap.contains(17998));
+}
+
+// Test intersection across container kinds
+TEST(RoaringBitmapTest, Intersection) {
+  RoaringBitmap evens;
+  RoaringBitmap threes;
+  for (uint32_t i = 0; i < 30000; ++i) {
+    evens.add(i * 2);
+  }
+  for (uint32_t i = 0; i < 1000; ++i) {
+    threes.add(i * 3);
+  }
+
+  RoaringBitmap both = evens.intersect(threes);
+  EXPECT_EQ(both.cardinality(), 500);
+  EXPECT_EQ(evens.intersectionCardinality(threes), 500);
+  EXPECT_TRUE(both.contains(6));
+  EXPECT_FALSE(both.contains(3));
+
+  RoaringBitmap evens_copy = evens;
+  EXPECT_EQ(evens.intersect(evens_copy), evens);
+  EXPECT_EQ(evens.intersectionCardinality(evens_copy), 30000);
+}
+
+// Test sorted output
+TEST(RoaringBitmapTest, ToVector) {
+  RoaringBitmap bitmap;
+  bitmap.add(200000);
+  bitmap.add(3);
+  bitmap.add(70000);
+
+  std::vector<uint32_t> expected{3, 70000, 200000};
+  EXPECT_EQ(bitmap.toVector(), expected);
+}
+
+// Test minimum and maximum across container kinds
+TEST(RoaringBitmapTest, MinimumMaximum) {
+  RoaringBitmap bitmap;
+  EXPECT_FALSE(bitmap.minimum().has_value());
+  EXPECT_FALSE(bitmap.maximum().has_value());
+
+  for (uint32_t value = 70000; value < 80000; ++value) {
+    bitmap.add(value);
+  }
+  bitmap.add(12);
+  EXPECT_EQ(bitmap.minimum(), 12);
+  EXPECT_EQ(bitmap.maximum(), 79999);
+
+  bitmap.remove(12);
+  EXPECT_EQ(bitmap.minimum(), 70000);
+}
+
+// Test that shrinking releases capacity without changing contents
+TEST(RoaringBitmapTest, ShrinkToFit) {
+  RoaringBitmap bitmap;
+  for (uint32_t value = 0; value < 4000; ++value) {
+    bitmap.add(value);
+  }
+  for (uint32_t value = 10; value < 4000; ++value) {
+    bitmap.remove(value);
+  }
+
+  size_t before = bitmap.memoryUsage();
+  bitmap.shrinkToFit();
+  EXPECT_LT(bitmap.memoryUsage(), before);
+  EXPECT_EQ(bitmap.cardinality(), 10);
+  EXPECT_TRUE(bitmap.contains(9));
+}
@@ -0,0 +1,75 @@
+#include "gtest/gtest.h"
+#include "search_index.h"
+
+// Test tokenization
+TEST(SearchIndexTest, Tokenize) {
+  auto tokens = SearchIndex::tokenize("Effective Modern C++: 42 Tips, C#!");
+  std::vector<std::string> expected{"effective", "modern", "c++", "42", "tips", "c#"};
+  EXPECT_EQ(tokens, expected);
+
+  tokens = SearchIndex::tokenize("Война и мир, Ωmega");
+  expected = {"Война", "и", "мир", "Ωmega"};
+  EXPECT_EQ(tokens, expected);
+}
+
+// Test that titles without any ASCII letters can be found
+TEST(SearchIndexTest, NonAsciiTitle) {
+  SearchIndex index;
+  index.addDocument(1, "Война и мир", "Лев Толстой");
+  index.addDocument(2, "Ὀδύσσεια", "Ὅμηρος");
+  index.addDocument(3, "War and Peace", "Leo Tolstoy");
+
+  auto hits = index.search("мир", 10);
+  ASSERT_EQ(hits.size(), 1);
+  EXPECT_EQ(hits[0].book_id, 1);
+
+  hits = index.search("Ὀδύσσεια", 10);
+  ASSERT_EQ(hits.size(), 1);
+  EXPECT_EQ(hits[0].book_id, 2);
+}
+
+// Test that title matches outrank author matches
+TEST(SearchIndexTest, TitleBoost) {
+  SearchIndex index;
+  index.addDocument(1, "Gardening Basics", "Anna Stroustrup");
+  index.addDocument(2, "Stroustrup Explained", "John Smith");
+  index.addDocument(3, "Cooking", "Jane Doe");
+
+  auto hits = index.search("stroustrup", 10);
+  ASSERT_EQ(hits.size(), 2);
+  EXPECT_EQ(hits[0].book_id, 2);
+  EXPECT_EQ(hits[1].book_id, 1);
+  EXPECT_GT(hits[0].score, hits[1].score);
+}
+
+// Test that only the best k hits are returned
+TEST(SearchIndexTest, TopK) {
+  SearchIndex index;
+  index.addDocument(1, "C++", "Author");
+  index.addDocument(2, "C++ C++", "Author");
+  index.addDocument(3, "Learning C++ the Long and Winding Way", "Author");
+  index.addDocument(4, "Python", "Author");
+
+  auto hits = index.search("C++", 2);
+  ASSERT_EQ(hits.size(), 2);
+  EXPECT_EQ(hits[0].book_id, 2);
+  EXPECT_EQ(hits[1].book_id, 1);
+
+  EXPECT_TRUE(index.search("C++", 0).empty());
+  EXPECT_TRUE(index.search("fortran", 5).empty());
+}
+
+// Test removing documents
+TEST(SearchIndexTest, RemoveDocument) {
+  SearchIndex index;
+  index.addDocument(1, "Rust in Action", "Tim McNamara");
+  index.addDocument(2, "Programming Rust", "Jim Blandy");
+
+  index.removeDocument(1, "Rust in Action", "Tim McNamara");
+  EXPECT_EQ(index.documentCount(), 1);
+
+  auto hits = index.search("rust", 10);
+  ASSERT_EQ(hits.size(), 1);
+  EXPECT_EQ(hits[0].book_id, 2);
+  EXPECT_TRUE(index.search("action", 10).empty());
+}
@@ -0,0 +1,53 @@
+#include "gtest/gtest.h"
+#include "string_heap.h"
+
+#include <string>
+
+// Test appending and viewing strings
+TEST(StringHeapTest, AppendAndView) {
+  StringHeap heap;
+  StringRef empty = heap.append("");
+  StringRef hello = heap.append("hello");
+  StringRef world = heap.append("world");
+
+  EXPECT_EQ(heap.view(empty), "");
+  EXPECT_EQ(heap.view(hello), "hello");
+  EXPECT_EQ(heap.view(world), "world");
+  EXPECT_EQ(world.offset, hello.offset + 5);
+}
+
+// Test strings that do not fit the rest of a window or span several windows
+TEST(StringHeapTest, WindowBoundaries) {
+  StringHeap heap;
+  std::string filler(StringHeap::kWindowSize - 3, 'a');
+  std::string large(3 * StringHeap::kWindowSize + 10, 'b');
+
+  StringRef first = heap.append(filler);
+  StringRef second = heap.append("abcdef");
+  StringRef third = heap.append(large);
+  StringRef fourth = heap.append("tail");
+
+  EXPECT_EQ(heap.view(first), filler);
+  EXPECT_EQ(second.offset, StringHeap::kWindowSize);
+  EXPECT_EQ(heap.view(second), "abcdef");
+  EXPECT_EQ(third.offset, 2 * StringHeap::kWindowSize);
+  EXPECT_EQ(heap.view(third), large);
+  EXPECT_EQ(heap.view(fourth), "tail");
+  EXPECT_EQ(fourth.offset, third.offset + large.size());
+}
+
+// Test that copies are isolated from later appends
+TEST(StringHeapTest, CopyOnWrite) {
+  StringHeap heap;
+  StringRef shared = heap.append("shared");
+
+  StringHeap copy = heap;
+  StringRef mine = heap.append("mine");
+  StringRef theirs = copy.append("theirs");
+
+  EXPECT_EQ(mine.offset, theirs.offset);
+  EXPECT_EQ(heap.view(mine), "mine");
+  EXPECT_EQ(copy.view(theirs), "theirs");
+  EXPECT_EQ(heap.view(shared), "shared");
+  EXPECT_EQ(copy.view(shared), "shared");
+}
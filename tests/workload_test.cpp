@@ -0,0 +1,182 @@
+#include "gtest/gtest.h"
+#include "library_manager.h"
+#include "workload.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+// Test that low ranks dominate a skewed Zipf distribution and that skew 0 is uniform
+TEST(WorkloadTest, ZipfDistribution) {
+  std::mt19937_64 random(42);
+  ZipfDistribution skewed(100, 1.0);
+  std::vector<size_t> counts(100);
+  for (int i = 0; i < 100000; ++i) {
+    size_t rank = skewed(random);
+    ASSERT_LT(rank, 100);
+    ++counts[rank];
+  }
+  // P(0) = 1 / H(100), about 19%, and P(0) / P(9) = 10
+  EXPECT_NEAR(counts[0], 19300, 1000);
+  EXPECT_GT(counts[0], counts[9] * 7);
+
+  ZipfDistribution uniform(4, 0.0);
+  std::vector<size_t> uniform_counts(4);
+  for (int i = 0; i < 40000; ++i) {
+    ++uniform_counts[uniform(random)];
+  }
+  for (size_t count : uniform_counts) {
+    EXPECT_NEAR(count, 10000, 600);
+  }
+
+  EXPECT_THROW(ZipfDistribution(0, 1.0), std::invalid_argument);
+
+  ZipfDistribution growing(1, 0.0);
+  growing.addRank();
+  EXPECT_EQ(growing.size(), 2);
+  size_t second = 0;
+  for (int i = 0; i < 10000; ++i) {
+    second += growing(random);
+  }
+  EXPECT_NEAR(second, 5000, 300);
+}
+
+// Test that books added during the stream are later requested
+TEST(WorkloadTest, AddedBooksArePicked) {
+  WorkloadOptions options;
+  options.books = 10;
+  options.mix.fill(0);
+  options.mix[static_cast<size_t>(OperationType::Add)] = 1;
+  options.mix[static_cast<size_t>(OperationType::Get)] = 1;
+  WorkloadGenerator generator(options);
+
+  unsigned int added = 0;
+  unsigned int newest_picked = 0;
+  for (int i = 0; i < 2000; ++i) {
+    Operation operation = generator.nextOperation();
+    if (operation.type == OperationType::Add) {
+      ++added;
+    } else {
+      ASSERT_GE(operation.book_id, 1);
+      ASSERT_LE(operation.book_id, 10 + added);
+      newest_picked = std::max(newest_picked, operation.book_id);
+    }
+  }
+  EXPECT_GT(added, 0);
+  EXPECT_GT(newest_picked, 10);
+}
+
+// Test that operations round-trip through the trace format
+TEST(WorkloadTest, TraceRoundTrip) {
+  WorkloadOptions options;
+  options.books = 500;
+  WorkloadGenerator generator(options);
+
+  std::string trace;
+  std::vector<Operation> operations;
+  for (int i = 0; i < 2000; ++i) {
+    operations.push_back(generator.nextOperation());
+    appendOperation(operations.back(), trace);
+  }
+  EXPECT_EQ(std::count(trace.begin(), trace.end(), '\n'), 2000);
+
+  std::string_view rest(trace);
+  for (const auto& operation : operations) {
+    size_t newline = rest.find('\n');
+    auto parsed = parseOperation(rest.substr(0, newline));
+    ASSERT_TRUE(parsed.has_value()) << rest.substr(0, newline);
+    EXPECT_EQ(parsed->type, operation.type);
+    EXPECT_EQ(parsed->book_id, operation.book_id);
+    EXPECT_EQ(parsed->text, operation.text);
+    rest.remove_prefix(newline + 1);
+  }
+
+  EXPECT_EQ(parseOperation("SEARCH RANKED night garden\r")->text, "night garden");
+  EXPECT_FALSE(parseOperation("STATS").has_value());
+  EXPECT_FALSE(parseOperation("BORROW x").has_value());
+  EXPECT_FALSE(parseOperation("SEARCH").has_value());
+  EXPECT_EQ(parseOperationName("search_author"), OperationType::SearchAuthor);
+  EXPECT_FALSE(parseOperationName("delete").has_value());
+}
+
+// Test that a seed always yields the same catalog, however many operations were generated
+TEST(WorkloadTest, CatalogDependsOnlyOnSeed) {
+  WorkloadOptions options;
+  options.books = 200;
+  options.seed = 7;
+
+  WorkloadGenerator first(options);
+  for (int i = 0; i < 100; ++i) {
+    (void)first.nextOperation();
+  }
+  LibraryManager first_catalog;
+  first.populate(first_catalog);
+
+  WorkloadGenerator second(options);
+  LibraryManager second_catalog;
+  second.populate(second_catalog);
+
+  ASSERT_EQ(first_catalog.getTotalBooks(), 200);
+  for (unsigned int id = 1; id <= 200; ++id) {
+    auto a = first_catalog.getBook(id);
+    auto b = second_catalog.getBook(id);
+    ASSERT_TRUE(a && b);
+    EXPECT_EQ(a->getTitle(), b->getTitle());
+    EXPECT_EQ(a->getAuthor(), b->getAuthor());
+    EXPECT_EQ(a->getISBN(), b->getISBN());
+    EXPECT_EQ(a->getPublicationYear(), b->getPublicationYear());
+    EXPECT_EQ(a->getCategory(), b->getCategory());
+    EXPECT_EQ(a->getISBN().size(), 14);
+  }
+
+  options.seed = 8;
+  WorkloadGenerator other(options);
+  EXPECT_NE(other.nextBook().getTitle() + other.nextBook().getTitle(),
+            first_catalog.getBook(1)->getTitle() + first_catalog.getBook(2)->getTitle());
+}
+
+// Test that every author rank gets a distinct name, even for huge catalogs
+TEST(WorkloadTest, AuthorNamesAreUnique) {
+  std::set<std::string> names;
+  for (size_t index = 0; index < 1'000'000; ++index) {
+    ASSERT_TRUE(names.insert(WorkloadGenerator::authorName(index)).second) << index;
+  }
+  EXPECT_EQ(WorkloadGenerator::authorName(0).find('.'), std::string::npos);
+  EXPECT_EQ(std::ranges::count(WorkloadGenerator::authorName(999'999), '.'), 2);
+}
+
+// Test that replay times every operation and counts rejections per type
+TEST(WorkloadTest, Replay) {
+  WorkloadOptions options;
+  options.books = 1000;
+  WorkloadGenerator generator(options);
+  LibraryManager manager;
+  generator.populate(manager);
+
+  std::vector<Operation> operations;
+  for (int i = 0; i < 5000; ++i) {
+    operations.push_back(generator.nextOperation());
+  }
+  operations.push_back({OperationType::Get, 5000, ""});
+  operations.push_back({OperationType::Add, 0, "Title only"});
+
+  ReplayReport report = replayOperations(manager, operations);
+  EXPECT_EQ(report.count(), operations.size());
+  EXPECT_GT(report.operationsPerSecond(), 0.0);
+
+  for (size_t i = 0; i < kOperationTypeCount; ++i) {
+    const OperationStats& stats = report.operations[i];
+    EXPECT_GT(stats.count, 0) << operationName(static_cast<OperationType>(i));
+    EXPECT_EQ(stats.nanos.size(), stats.count);
+    EXPECT_TRUE(std::is_sorted(stats.nanos.begin(), stats.nanos.end()));
+    EXPECT_LE(stats.percentile(0.5), stats.percentile(0.99));
+    EXPECT_EQ(stats.percentile(1.0), stats.nanos.back());
+  }
+  size_t adds = report.operations[static_cast<size_t>(OperationType::Add)].count;
+
+  // Only the unknown ID and the ADD without an author are rejected
+  EXPECT_EQ(report.operations[static_cast<size_t>(OperationType::Get)].rejected, 1);
+  EXPECT_EQ(report.operations[static_cast<size_t>(OperationType::Add)].rejected, 1);
+  EXPECT_EQ(report.operations[static_cast<size_t>(OperationType::SearchCategory)].rejected, 0);
+  EXPECT_EQ(manager.getTotalBooks(), 1000 + adds - 1);
+}
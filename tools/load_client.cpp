@@ -0,0 +1,224 @@
+// Load generator for `lms --serve`: opens several loopback connections and
+// keeps a fixed number of pipelined requests in flight on each of them.
+//
+//   lms_load_client [port] [connections] [requests per connection] [pipeline depth]
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  uint16_t port{7070};
+  size_t connections{8};
+  size_t requests{20000};
+  size_t depth{32};
+};
+
+struct WorkerResult {
+  size_t responses{0};
+  size_t rejected{0}; // ERR responses, e.g. borrowing a book that is already out
+  size_t failures{0}; // requests lost to connection errors
+  std::vector<double> batch_micros;
+};
+
+// Buffered line reader over a blocking socket
+class LineReader {
+public:
+  explicit LineReader(int fd) : fd_(fd) {}
+
+  bool readLine(std::string& line) {
+    while (true) {
+      size_t newline = buffer_.find('\n', offset_);
+      if (newline != std::string::npos) {
+        line.assign(buffer_, offset_, newline - offset_);
+        offset_ = newline + 1;
+        return true;
+      }
+
+      buffer_.erase(0, offset_);
+      offset_ = 0;
+      char chunk[64 * 1024];
+      ssize_t received = ::recv(fd_, chunk, sizeof(chunk), 0);
+      if (received <= 0) {
+        return false;
+      }
+      buffer_.append(chunk, static_cast<size_t>(received));
+    }
+  }
+
+private:
+  int fd_;
+  std::string buffer_;
+  size_t offset_{0};
+};
+
+// Mix of read-heavy requests; the bool marks requests answered with a book list
+std::pair<std::string_view, bool> requestFor(size_t n) {
+  static constexpr std::pair<std::string_view, bool> kRequests[] = {
+      {"GET 1\n", true},
+      {"SEARCH RANKED c++\n", true},
+      {"STATS\n", false},
+      {"GET 2\n", true},
+      {"SEARCH TITLE Design\n", true},
+      {"BORROW 3\n", false},
+      {"RETURN 3\n", false},
+      {"SEARCH CATEGORY Programming\n", true},
+  };
+  return kRequests[n % std::size(kRequests)];
+}
+
+int connectLoopback(uint16_t port) {
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    return -1;
+  }
+  return fd;
+}
+
+bool sendAll(int fd, std::string_view data) {
+  while (!data.empty()) {
+    ssize_t sent = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (sent <= 0) {
+      return false;
+    }
+    data.remove_prefix(static_cast<size_t>(sent));
+  }
+  return true;
+}
+
+WorkerResult runWorker(const Options& options, size_t worker) {
+  WorkerResult result;
+  int fd = connectLoopback(options.port);
+  if (fd < 0) {
+    result.failures = options.requests;
+    return result;
+  }
+
+  LineReader reader(fd);
+  std::string batch;
+  std::string line;
+  size_t next = worker;
+
+  for (size_t done = 0; done < options.requests;) {
+    size_t count = std::min(options.depth, options.requests - done);
+    std::vector<bool> lists;
+    batch.clear();
+    for (size_t i = 0; i < count; ++i) {
+      auto [request, returns_list] = requestFor(next++);
+      batch += request;
+      lists.push_back(returns_list);
+    }
+
+    auto start = Clock::now();
+    if (!sendAll(fd, batch)) {
+      result.failures += options.requests - done;
+      break;
+    }
+
+    for (bool returns_list : lists) {
+      if (!reader.readLine(line)) {
+        ::close(fd);
+        result.failures += options.requests - done;
+        return result;
+      }
+      if (line.starts_with("ERR")) {
+        ++result.rejected;
+      } else if (returns_list) {
+        size_t books = 0;
+        std::from_chars(line.data() + 3, line.data() + line.size(), books);
+        for (size_t i = 0; i < books; ++i) {
+          reader.readLine(line);
+        }
+      }
+      ++result.responses;
+    }
+    result.batch_micros.push_back(
+        std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    done += count;
+  }
+
+  ::close(fd);
+  return result;
+}
+
+double percentile(std::vector<double>& values, double p) {
+  if (values.empty()) {
+    return 0.0;
+  }
+  size_t index = static_cast<size_t>(p * static_cast<double>(values.size() - 1));
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return values[index];
+}
+
+template <typename T> bool parseArg(const char* arg, T& value) {
+  std::string_view text(arg);
+  auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+  return error == std::errc() && end == text.data() + text.size();
+}
+
+} // namespace
+
+auto main(int argc, char* argv[]) -> int {
+  Options options;
+  bool valid = (argc <= 1 || parseArg(argv[1], options.port)) &&
+               (argc <= 2 || parseArg(argv[2], options.connections)) &&
+               (argc <= 3 || parseArg(argv[3], options.requests)) &&
+               (argc <= 4 || parseArg(argv[4], options.depth));
+  if (!valid || options.connections == 0 || options.depth == 0) {
+    std::println("Usage: lms_load_client [port] [connections] [requests] [pipeline depth]");
+    return 1;
+  }
+
+  std::vector<WorkerResult> results(options.connections);
+  auto start = Clock::now();
+  {
+    std::vector<std::jthread> workers;
+    for (size_t i = 0; i < options.connections; ++i) {
+      workers.emplace_back([&, i] { results[i] = runWorker(options, i); });
+    }
+  }
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  size_t responses = 0;
+  size_t rejected = 0;
+  size_t failures = 0;
+  std::vector<double> latencies;
+  for (auto& result : results) {
+    responses += result.responses;
+    rejected += result.rejected;
+    failures += result.failures;
+    latencies.insert(latencies.end(), result.batch_micros.begin(), result.batch_micros.end());
+  }
+
+  std::println("Connections:     {}", options.connections);
+  std::println("Pipeline depth:  {}", options.depth);
+  std::println("Responses:       {} ({} rejected, {} lost)", responses, rejected, failures);
+  std::println("Throughput:      {:.0f} requests/s", static_cast<double>(responses) / seconds);
+  std::println("Batch latency:   p50 {:.1f} us, p99 {:.1f} us",
+               percentile(latencies, 0.50),
+               percentile(latencies, 0.99));
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,246 @@
+// Synthetic workload for capacity planning: generates a catalog and a mix of
+// operations with Zipf-distributed popularity, or replays a recorded trace,
+// against an in-process LibraryManager and reports throughput and latency
+// percentiles per operation type.
+//
+//   lms_workload [--books N] [--operations N] [--skew S] [--seed N]
+//                [--mix name=weight,...] [--cache entries]
+//                [--record <trace> | --replay <trace>]
+//
+// A trace starts with "# lms_workload books=<N> seed=<S>" so replaying it
+// regenerates the same catalog, followed by one request per line.
+
+#include "../include/library_manager.h"
+#include "../include/workload.h"
+
+#include <charconv>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::string_view kTraceHeader = "# lms_workload";
+
+struct Options {
+  WorkloadOptions workload;
+  size_t operations{20000};
+  size_t cache_capacity{0};
+  std::string record_path;
+  std::string replay_path;
+};
+
+void printUsage() {
+  std::println("Usage: lms_workload [--books N] [--operations N] [--skew S] [--seed N]");
+  std::println("                    [--mix name=weight,...] [--cache entries]");
+  std::println("                    [--record <trace> | --replay <trace>]");
+  std::print("Operation names:");
+  for (size_t i = 0; i < kOperationTypeCount; ++i) {
+    std::print(" {}", operationName(static_cast<OperationType>(i)));
+  }
+  std::println("");
+}
+
+template <typename T> bool parseValue(std::string_view text, T& value) {
+  auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+  return error == std::errc() && end == text.data() + text.size();
+}
+
+// "borrow=20,return=20" sets those weights and zeroes every other one
+bool parseMix(std::string_view text, OperationMix& mix) {
+  mix.fill(0);
+  while (!text.empty()) {
+    size_t comma = text.find(',');
+    std::string_view entry = text.substr(0, comma);
+    size_t equals = entry.find('=');
+    if (equals == std::string_view::npos) {
+      return false;
+    }
+    auto type = parseOperationName(entry.substr(0, equals));
+    if (!type || !parseValue(entry.substr(equals + 1), mix[static_cast<size_t>(*type)])) {
+      return false;
+    }
+    text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
+  }
+  return true;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg(argv[i]);
+    if (i + 1 >= argc) {
+      return false;
+    }
+    std::string_view value(argv[++i]);
+
+    bool valid = true;
+    if (arg == "--books") {
+      valid = parseValue(value, options.workload.books);
+    } else if (arg == "--operations") {
+      valid = parseValue(value, options.operations);
+    } else if (arg == "--skew") {
+      valid = parseValue(value, options.workload.popularity_skew);
+    } else if (arg == "--seed") {
+      valid = parseValue(value, options.workload.seed);
+    } else if (arg == "--mix") {
+      valid = parseMix(value, options.workload.mix);
+    } else if (arg == "--cache") {
+      valid = parseValue(value, options.cache_capacity);
+    } else if (arg == "--record") {
+      options.record_path = value;
+    } else if (arg == "--replay") {
+      options.replay_path = value;
+    } else {
+      valid = false;
+    }
+    if (!valid) {
+      return false;
+    }
+  }
+  return options.workload.books > 0 && options.workload.popularity_skew >= 0.0 &&
+         (options.record_path.empty() || options.replay_path.empty());
+}
+
+// Reads the catalog parameters from the header and every operation after it
+bool readTrace(const std::string& path, Options& options, std::vector<Operation>& operations) {
+  std::ifstream in(path);
+  if (!in) {
+    std::println("Cannot open {}", path);
+    return false;
+  }
+
+  std::string line;
+  std::getline(in, line);
+  std::string_view header(line);
+  size_t books_at = header.find(" books=");
+  size_t seed_at = header.find(" seed=");
+  if (!header.starts_with(kTraceHeader) || books_at == std::string_view::npos ||
+      seed_at == std::string_view::npos || seed_at < books_at ||
+      !parseValue(header.substr(books_at + 7, seed_at - books_at - 7), options.workload.books) ||
+      !parseValue(header.substr(seed_at + 6), options.workload.seed)) {
+    std::println("{}: missing \"{} books=<N> seed=<S>\" header", path, kTraceHeader);
+    return false;
+  }
+
+  for (size_t number = 2; std::getline(in, line); ++number) {
+    auto operation = parseOperation(line);
+    if (!operation) {
+      std::println("{}:{}: unsupported operation", path, number);
+      return false;
+    }
+    operations.push_back(std::move(*operation));
+  }
+  return true;
+}
+
+bool writeTrace(const std::string& path,
+                const Options& options,
+                const std::vector<Operation>& operations) {
+  std::string out = std::string(kTraceHeader) + " books=" +
+                    std::to_string(options.workload.books) +
+                    " seed=" + std::to_string(options.workload.seed) + "\n";
+  for (const auto& operation : operations) {
+    appendOperation(operation, out);
+  }
+
+  std::ofstream file(path, std::ios::binary);
+  file.write(out.data(), static_cast<std::streamsize>(out.size()));
+  if (!file) {
+    std::println("Cannot write {}", path);
+    return false;
+  }
+  return true;
+}
+
+double micros(uint64_t nanos) {
+  return static_cast<double>(nanos) / 1000.0;
+}
+
+void printReport(const ReplayReport& report) {
+  std::println("Operations:  {} in {:.2f} s, {:.0f} ops/s",
+               report.count(),
+               report.seconds,
+               report.operationsPerSecond());
+  std::println("");
+  std::println("{:<16} {:>9} {:>9} {:>10} {:>10} {:>10} {:>10} {:>10}",
+               "operation",
+               "count",
+               "rejected",
+               "p50 us",
+               "p90 us",
+               "p99 us",
+               "p99.9 us",
+               "max us");
+
+  for (size_t i = 0; i < kOperationTypeCount; ++i) {
+    const OperationStats& stats = report.operations[i];
+    if (stats.count == 0) {
+      continue;
+    }
+    std::println("{:<16} {:>9} {:>9} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f}",
+                 operationName(static_cast<OperationType>(i)),
+                 stats.count,
+                 stats.rejected,
+                 micros(stats.percentile(0.50)),
+                 micros(stats.percentile(0.90)),
+                 micros(stats.percentile(0.99)),
+                 micros(stats.percentile(0.999)),
+                 micros(stats.percentile(1.0)));
+  }
+}
+
+} // namespace
+
+auto main(int argc, char* argv[]) -> int {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    printUsage();
+    return 1;
+  }
+
+  std::vector<Operation> operations;
+  if (!options.replay_path.empty() && !readTrace(options.replay_path, options, operations)) {
+    return 1;
+  }
+
+  try {
+    WorkloadGenerator generator(options.workload);
+
+    LibraryManager manager;
+    if (options.cache_capacity > 0) {
+      manager.enableQueryCache(options.cache_capacity);
+    }
+    auto start = Clock::now();
+    generator.populate(manager);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::println("Catalog:     {} books (seed {}) in {:.2f} s, {:.0f} books/s, {:.1f} bytes/book",
+                 options.workload.books,
+                 options.workload.seed,
+                 seconds,
+                 static_cast<double>(options.workload.books) / seconds,
+                 manager.getMemoryUsage().bytesPerBook());
+
+    if (options.replay_path.empty()) {
+      operations.reserve(options.operations);
+      for (size_t i = 0; i < options.operations; ++i) {
+        operations.push_back(generator.nextOperation());
+      }
+    }
+    if (!options.record_path.empty() && !writeTrace(options.record_path, options, operations)) {
+      return 1;
+    }
+
+    printReport(replayOperations(manager, operations));
+  } catch (const std::exception& error) {
+    std::println("Error: {}", error.what());
+    return 1;
+  }
+  return 0;
+}